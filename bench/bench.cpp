@@ -0,0 +1,257 @@
+/*
+ * A benchmark program running every string range matching algorithm of the
+ * command line program over locally generated synthetic corpora of different
+ * sizes and printing throughput and peak memory consumption as CSV.
+ *
+ * Copyright (c) 2015 Jarno Leppänen
+ */
+
+#include "method.hpp"
+#include "corpus.hpp"
+#include "timer.hpp"
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <atomic>
+#include <new>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdarg>
+#include <getopt.h>
+#include <malloc.h>
+
+using namespace std;
+
+/* Heap usage bookkeeping of the replaced global allocation functions, which
+   are also called from the threads of the parallel methods. */
+static atomic<size_t> heap_current(0);
+static atomic<size_t> heap_peak(0);
+
+/* The replaced allocation functions count the usable size of each block as
+   reported by malloc, so that freeing a block needs no header of its own. */
+void *operator new(size_t bytes)
+{
+    void *p = malloc(bytes ? bytes : 1);
+    if (!p) throw bad_alloc();
+    size_t current = heap_current += malloc_usable_size(p);
+    size_t peak = heap_peak.load();
+    while (peak < current && !heap_peak.compare_exchange_weak(peak,current)) ;
+    return p;
+}
+
+__attribute__((noinline)) void operator delete(void *ptr) noexcept
+{
+    if (!ptr) return;
+    heap_current -= malloc_usable_size(ptr);
+    free(ptr);
+}
+
+void *operator new[](size_t bytes)
+{
+    return operator new(bytes);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    operator delete(ptr);
+}
+
+const char *shopts = "hn:N:r:l:x:m:k:";
+
+const option opts[] = {
+    { "help",    no_argument,       nullptr, 'h' },
+    { "min",     required_argument, nullptr, 'n' },
+    { "max",     required_argument, nullptr, 'N' },
+    { "repeat",  required_argument, nullptr, 'r' },
+    { "length",  required_argument, nullptr, 'l' },
+    { "seed",    required_argument, nullptr, 'x' },
+    { "method",  required_argument, nullptr, 'm' },
+    { "k",       required_argument, nullptr, 'k' },
+    { nullptr,   no_argument,       nullptr,  0  }
+};
+
+const char *help_str = R"STR(
+Runs every matching algorithm over synthetic corpora (random texts over
+alphabets of size 2, 4, 16 and 256, the Fibonacci word, a periodic text and
+Markov generated natural-text-like data) with text sizes growing by a factor of
+4 and prints a CSV line for each run.
+
+Mandatory arguments to long options are mandatory for short options too.
+  -h, --help           display this help and exit
+  -n, --min=SIZE       smallest text size; default is 65536
+  -N, --max=SIZE       largest text size; default is 4194304
+  -r, --repeat=COUNT   run each algorithm COUNT times and report the fastest
+                         run; default is 3
+  -l, --length=LENGTH  length of the bound patterns picked from the text;
+                         default is 8
+  -x, --seed=SEED      seed of the corpus generator; default is 1
+  -m, --method=METHOD  only run algorithm METHOD; see rmatch --help for the
+                         possible values
+  -k, --k=VALUE        k of the Galil-Seiferas count; default is 3
+)STR";
+
+void help(FILE *f, const char *app)
+{
+    fprintf(f, "Usage: %s [OPTION]\n", app);
+    fprintf(f,"%s",help_str);
+}
+
+void nag(const char *app, const char *fmt...)
+{
+    va_list args;
+    va_start(args, fmt);
+    fprintf(stderr, "%s: ", app);
+    vfprintf(stderr, fmt, args);
+    va_end(args);
+}
+
+/* Benchmark parameters. */
+struct params {
+    size_t min;
+    size_t max;
+    size_t repeat;
+    size_t length;
+    uint32_t seed;
+    size_t k;
+    bool all;
+    method m;
+    int ret;
+    params():
+        min(1<<16), max(1<<22), repeat(3), length(8), seed(1), k(3),
+        all(true), m(NAIVE), ret(0) {}
+};
+
+bool fail(params& p)
+{
+    p.ret = 1;
+    return false;
+}
+
+/* Read benchmark parameters from command line arguments. */
+bool init(int argc, char *const argv[], params& p)
+{
+    int c;
+    const char *app = argv[0];
+    while ((c = getopt_long(argc, argv, shopts, opts, nullptr)) != -1) {
+        switch (c) {
+            case 'h':
+                help(stdout, app);
+                return false;
+            case 'n':
+                p.min = atol(optarg);
+                break;
+            case 'N':
+                p.max = atol(optarg);
+                break;
+            case 'r':
+                p.repeat = atol(optarg);
+                break;
+            case 'l':
+                p.length = atol(optarg);
+                break;
+            case 'x':
+                p.seed = atol(optarg);
+                break;
+            case 'm':
+                if (!parse_method(optarg,p.m)) {
+                    nag(app,"unknown method \"%s\"\n",optarg);
+                    return fail(p);
+                }
+                p.all = false;
+                break;
+            case 'k':
+                p.k = atol(optarg);
+                if (p.k < 3) {
+                    nag(app,"k must be an integer larger or equal to 3\n");
+                    return fail(p);
+                }
+                break;
+            case '?':
+            default:
+                return fail(p);
+        }
+    }
+    if (p.min == 0 || p.min > p.max || p.repeat == 0 || p.length == 0) {
+        nag(app,"SIZE, COUNT and LENGTH must be positive and MIN <= MAX\n");
+        return fail(p);
+    }
+    return true;
+}
+
+/* Corpus types of the benchmark. */
+enum corpus {
+    RANDOM2,
+    RANDOM4,
+    RANDOM16,
+    RANDOM256,
+    FIBONACCI,
+    PERIODIC,
+    MARKOV,
+    CORPUS_COUNT
+};
+
+const char *const corpus_names[CORPUS_COUNT] = {
+    "random2", "random4", "random16", "random256",
+    "fibonacci", "periodic", "markov"
+};
+
+string generate(corpus_generator& gen, corpus c, size_t n)
+{
+    switch (c) {
+        case RANDOM2:   return gen.random(n,2);
+        case RANDOM4:   return gen.random(n,4);
+        case RANDOM16:  return gen.random(n,16);
+        case RANDOM256: return gen.random(n,256);
+        case FIBONACCI: return gen.fibonacci(n);
+        case PERIODIC:  return gen.periodic(n,7);
+        case MARKOV:    return gen.markov(n);
+        default:        return string();
+    }
+}
+
+/* Run a single algorithm repeatedly and print the fastest run as CSV. */
+void bench(const params& p, const char *name, const string& t,
+        const string& b, const string& e, method m)
+{
+    double best = numeric_limits<double>::max();
+    size_t peak = 0, c = 0;
+    for (size_t r = 0; r < p.repeat; ++r) {
+        vector<size_t> out;
+        size_t base = heap_current;
+        heap_peak = base;
+        profiler prof(false);
+        c = run_method(m,t,b,e,p.k,out,prof);
+        best = min(best,prof.total().span);
+        peak = max(peak,heap_peak-base);
+    }
+    const double n = t.size();
+    printf("%s,%zu,%s,%zu,%.6f,%.3f,%.3f,%zu\n", name, t.size(),
+            method_names[m], c, best, n/best/1e6, best*1e9/n, peak);
+    fflush(stdout);
+}
+
+int main(int argc, char *const argv[])
+{
+    params p;
+    if (!init(argc, argv, p)) return p.ret;
+
+    printf("corpus,n,method,matches,seconds,mchars_per_s,ns_per_char,"
+            "peak_bytes\n");
+    for (int c = 0; c < CORPUS_COUNT; ++c) {
+        for (size_t n = p.min; n <= p.max; n *= 4) {
+            // every corpus and size gets its own deterministic generator
+            corpus_generator gen(p.seed+1000003*c+n);
+            string t = generate(gen,static_cast<corpus>(c),n);
+            string b = gen.substring(t,p.length);
+            string e = gen.substring(t,p.length);
+            if (lexicographical_compare(e.begin(),e.end(),b.begin(),b.end()))
+                b.swap(e);
+            for (int m = 0; m < METHOD_COUNT; ++m) {
+                if (!p.all && m != p.m) continue;
+                bench(p,corpus_names[c],t,b,e,static_cast<method>(m));
+            }
+        }
+    }
+    return 0;
+}
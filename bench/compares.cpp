@@ -0,0 +1,251 @@
+/*
+ * A benchmark program counting the character comparisons done by every string
+ * range matching algorithm of the command line program on adversarial periodic
+ * and near-periodic inputs. Linear time algorithms should do a constant number
+ * of comparisons per text position regardless of the pattern length.
+ *
+ * Copyright (c) 2015 Jarno Leppänen
+ */
+
+#include "method.hpp"
+#include "corpus.hpp"
+#include "timer.hpp"
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdarg>
+#include <cstdint>
+#include <getopt.h>
+
+using namespace std;
+
+/* Number of character comparisons done since the last reset. */
+static uint64_t compares = 0;
+
+/* A character counting every comparison made with it. */
+struct cchar {
+    char c;
+};
+
+inline bool operator==(cchar a, cchar b) { ++compares; return a.c == b.c; }
+inline bool operator!=(cchar a, cchar b) { ++compares; return a.c != b.c; }
+inline bool operator<(cchar a, cchar b)  { ++compares; return a.c < b.c; }
+inline bool operator>(cchar a, cchar b)  { ++compares; return a.c > b.c; }
+inline bool operator<=(cchar a, cchar b) { ++compares; return a.c <= b.c; }
+inline bool operator>=(cchar a, cchar b) { ++compares; return a.c >= b.c; }
+
+typedef basic_string<cchar> cstring;
+
+namespace rmatch {
+/* Suffix array construction sees counted characters as plain characters
+   without counting; only the comparisons of the bound search are counted. */
+template <>
+struct symbol_key<cchar> {
+    typedef char type;
+    static type get(cchar c) { return c.c; }
+};
+}
+
+cstring counted(const string& s)
+{
+    cstring r(s.size(),cchar());
+    for (size_t i = 0; i < s.size(); ++i) r[i].c = s[i];
+    return r;
+}
+
+const char *shopts = "hn:l:L:e:x:m:k:w:";
+
+const option opts[] = {
+    { "help",       no_argument,       nullptr, 'h' },
+    { "size",       required_argument, nullptr, 'n' },
+    { "min",        required_argument, nullptr, 'l' },
+    { "max",        required_argument, nullptr, 'L' },
+    { "mismatches", required_argument, nullptr, 'e' },
+    { "seed",       required_argument, nullptr, 'x' },
+    { "method",     required_argument, nullptr, 'm' },
+    { "k",          required_argument, nullptr, 'k' },
+    { "work",       required_argument, nullptr, 'w' },
+    { nullptr,      no_argument,       nullptr,  0  }
+};
+
+const char *help_str = R"STR(
+Runs every matching algorithm over adversarial corpora (runs, the Fibonacci and
+Thue-Morse words, periodic and near-periodic texts and a random binary text as
+a baseline) with bound patterns of growing length and prints a CSV line with
+the number of character comparisons per text position for each run. The bound
+patterns are substrings of the text with a controlled number of mismatches.
+
+Mandatory arguments to long options are mandatory for short options too.
+  -h, --help              display this help and exit
+  -n, --size=SIZE         text size; default is 1048576
+  -l, --min=LENGTH        smallest pattern length; default is 4
+  -L, --max=LENGTH        largest pattern length; default is 4096
+  -e, --mismatches=COUNT  number of mismatches in each pattern; default is 1
+  -x, --seed=SEED         seed of the corpus generator; default is 1
+  -m, --method=METHOD     only run algorithm METHOD; see rmatch --help for the
+                            possible values
+  -k, --k=VALUE           k of the Galil-Seiferas count; default is 3
+  -w, --work=LIMIT        skip naive search when text size times pattern
+                            length exceeds LIMIT; default is 1073741824
+)STR";
+
+void help(FILE *f, const char *app)
+{
+    fprintf(f, "Usage: %s [OPTION]\n", app);
+    fprintf(f,"%s",help_str);
+}
+
+void nag(const char *app, const char *fmt...)
+{
+    va_list args;
+    va_start(args, fmt);
+    fprintf(stderr, "%s: ", app);
+    vfprintf(stderr, fmt, args);
+    va_end(args);
+}
+
+/* Benchmark parameters. */
+struct params {
+    size_t n;
+    size_t min;
+    size_t max;
+    size_t mismatches;
+    uint32_t seed;
+    size_t k;
+    size_t work;
+    bool all;
+    method m;
+    int ret;
+    params():
+        n(1<<20), min(4), max(4096), mismatches(1), seed(1), k(3),
+        work(size_t(1)<<30), all(true), m(NAIVE), ret(0) {}
+};
+
+bool fail(params& p)
+{
+    p.ret = 1;
+    return false;
+}
+
+/* Read benchmark parameters from command line arguments. */
+bool init(int argc, char *const argv[], params& p)
+{
+    int c;
+    const char *app = argv[0];
+    while ((c = getopt_long(argc, argv, shopts, opts, nullptr)) != -1) {
+        switch (c) {
+            case 'h':
+                help(stdout, app);
+                return false;
+            case 'n':
+                p.n = atol(optarg);
+                break;
+            case 'l':
+                p.min = atol(optarg);
+                break;
+            case 'L':
+                p.max = atol(optarg);
+                break;
+            case 'e':
+                p.mismatches = atol(optarg);
+                break;
+            case 'x':
+                p.seed = atol(optarg);
+                break;
+            case 'm':
+                if (!parse_method(optarg,p.m)) {
+                    nag(app,"unknown method \"%s\"\n",optarg);
+                    return fail(p);
+                }
+                p.all = false;
+                break;
+            case 'k':
+                p.k = atol(optarg);
+                if (p.k < 3) {
+                    nag(app,"k must be an integer larger or equal to 3\n");
+                    return fail(p);
+                }
+                break;
+            case 'w':
+                p.work = atol(optarg);
+                break;
+            case '?':
+            default:
+                return fail(p);
+        }
+    }
+    if (p.n == 0 || p.min == 0 || p.min > p.max) {
+        nag(app,"SIZE and LENGTH must be positive and MIN <= MAX\n");
+        return fail(p);
+    }
+    return true;
+}
+
+/* Corpus types of the benchmark. */
+enum corpus {
+    RANDOM2,
+    FIBONACCI,
+    THUE_MORSE,
+    RUNS,
+    PERIODIC,
+    NEAR_PERIODIC,
+    CORPUS_COUNT
+};
+
+const char *const corpus_names[CORPUS_COUNT] = {
+    "random2", "fibonacci", "thue-morse", "runs", "periodic", "near-periodic"
+};
+
+string generate(corpus_generator& gen, corpus c, size_t n)
+{
+    switch (c) {
+        case RANDOM2:       return gen.random(n,2);
+        case FIBONACCI:     return gen.fibonacci(n);
+        case THUE_MORSE:    return gen.thue_morse(n);
+        case RUNS:          return gen.runs(n,64);
+        case PERIODIC:      return gen.periodic(n,5);
+        case NEAR_PERIODIC: return gen.mutate(gen.periodic(n,5),n/1024);
+        default:            return string();
+    }
+}
+
+int main(int argc, char *const argv[])
+{
+    params p;
+    if (!init(argc, argv, p)) return p.ret;
+
+    printf("corpus,n,m,method,matches,compares,compares_per_char\n");
+    for (int c = 0; c < CORPUS_COUNT; ++c) {
+        corpus_generator gen(p.seed+1000003*c);
+        const string t = generate(gen,static_cast<corpus>(c),p.n);
+        const cstring ct = counted(t);
+        for (size_t m = p.min; m <= p.max; m *= 4) {
+            string b = gen.mutate(gen.substring(t,m),p.mismatches);
+            string e = gen.mutate(gen.substring(t,m),p.mismatches);
+            if (lexicographical_compare(e.begin(),e.end(),b.begin(),b.end()))
+                b.swap(e);
+            const cstring cb = counted(b), ce = counted(e);
+            for (int i = 0; i < METHOD_COUNT; ++i) {
+                method r = static_cast<method>(i);
+                if (!p.all && r != p.m) continue;
+                if (r == NAIVE && t.size()*b.size() > p.work) {
+                    nag(argv[0],"skipping naive search on %s with m = %zu\n",
+                            corpus_names[c],b.size());
+                    continue;
+                }
+                vector<size_t> out;
+                profiler prof(false);
+                compares = 0;
+                size_t matches = run_method(r,ct,cb,ce,p.k,out,prof);
+                printf("%s,%zu,%zu,%s,%zu,%llu,%.3f\n", corpus_names[c],
+                        t.size(), b.size(), method_names[r], matches,
+                        (unsigned long long)compares,
+                        double(compares)/t.size());
+                fflush(stdout);
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,139 @@
+/*
+ * Synthetic text corpus generator implementation
+ *
+ * Copyright (c) 2015 Jarno Leppänen
+ */
+
+#include "corpus.hpp"
+#include "Util.hpp"
+#include <vector>
+#include <map>
+#include <utility>
+#include <algorithm>
+
+using namespace std;
+
+/* Training sample of the Markov model. */
+static const char *markov_sample =
+    "the suffix array of a text is the lexicographically sorted array of "
+    "all of its suffixes. given two patterns, string range matching asks "
+    "for all the positions of the text whose suffixes are larger than or "
+    "equal to the first pattern and smaller than the second one. the naive "
+    "method compares every suffix with both of the patterns, while the "
+    "linear time methods reuse the information gained from the previous "
+    "comparisons to skip over positions that are known to be smaller. when "
+    "the text is long and the patterns are short, most of the time is spent "
+    "reading the text from memory, and an algorithm that needs only a small "
+    "amount of extra space can process inputs that would never fit into "
+    "the memory of a single machine. this makes the problem interesting for "
+    "splitting large texts into blocks of suffixes that are sorted one at a "
+    "time when building the burrows wheeler transform of the whole text.";
+
+corpus_generator::corpus_generator(uint32_t seed): rng(seed)
+{
+}
+
+size_t corpus_generator::below(size_t bound)
+{
+    return rmatch::uniformBelow(rng,bound);
+}
+
+string corpus_generator::random(size_t n, unsigned sigma)
+{
+    char base = sigma <= 26 ? 'a' : 0;
+    string t(n,0);
+    for (size_t i = 0; i < n; ++i) t[i] = static_cast<char>(base+below(sigma));
+    return t;
+}
+
+string corpus_generator::fibonacci(size_t n)
+{
+    string a = "a", b = "ab";
+    while (b.size() < n) {
+        string c = b + a;
+        a.swap(b);
+        b.swap(c);
+    }
+    b.resize(n);
+    return b;
+}
+
+string corpus_generator::periodic(size_t n, size_t period)
+{
+    return repeat(root(period),n);
+}
+
+string corpus_generator::thue_morse(size_t n)
+{
+    string t(n,0);
+    for (size_t i = 0; i < n; ++i) {
+        unsigned parity = 0;
+        for (size_t j = i; j; j &= j-1) parity ^= 1;
+        t[i] = 'a'+parity;
+    }
+    return t;
+}
+
+string corpus_generator::runs(size_t n, size_t max_run)
+{
+    string t;
+    t.reserve(n);
+    char c = 'a';
+    while (t.size() < n) {
+        t.append(min(1+below(max_run),n-t.size()),c);
+        c = c == 'a' ? 'b' : 'a';
+    }
+    return t;
+}
+
+string corpus_generator::root(size_t period)
+{
+    return random(period,4);
+}
+
+string corpus_generator::repeat(const string& root, size_t n)
+{
+    string t(n,0);
+    for (size_t i = 0; i < n; ++i) t[i] = root[i%root.size()];
+    return t;
+}
+
+string corpus_generator::mutate(string s, size_t mismatches)
+{
+    mismatches = min(mismatches,s.size());
+    vector<size_t> pos(s.size());
+    for (size_t i = 0; i < pos.size(); ++i) pos[i] = i;
+    // partial Fisher-Yates shuffle picks distinct positions
+    for (size_t i = 0; i < mismatches; ++i) {
+        swap(pos[i],pos[i+below(pos.size()-i)]);
+        char& c = s[pos[i]];
+        c = 'a'+(c-'a'+1+below(3))%4;
+    }
+    return s;
+}
+
+string corpus_generator::markov(size_t n)
+{
+    typedef pair<char,char> state;
+    const string sample(markov_sample);
+    const size_t s = sample.size();
+    map<state,vector<char>> follow;
+    for (size_t i = 0; i < s; ++i) {
+        state q(sample[i],sample[(i+1)%s]);
+        follow[q].push_back(sample[(i+2)%s]);
+    }
+    string t(n,0);
+    state q(sample[0],sample[1]);
+    for (size_t i = 0; i < n; ++i) {
+        const vector<char>& f = follow[q];
+        t[i] = f[below(f.size())];
+        q = state(q.second,t[i]);
+    }
+    return t;
+}
+
+string corpus_generator::substring(const string& t, size_t m)
+{
+    if (m > t.size()) m = t.size();
+    return t.substr(below(t.size()-m+1),m);
+}
@@ -0,0 +1,135 @@
+/*
+ * Reproducible synthetic text corpora for benchmarking string range matching
+ * algorithms.
+ *
+ * Copyright (c) 2015 Jarno Leppänen
+ */
+
+#ifndef CORPUS_HPP
+#define CORPUS_HPP
+
+#include <string>
+#include <random>
+#include <cstdint>
+
+/**
+ * Corpus generator class produces texts of different statistical and
+ * combinatorial structure from a pseudo-random generator with a fixed seed.
+ * Random numbers are drawn from the generator with a bounded draw of its own
+ * instead of the standard distributions, whose algorithms differ between
+ * standard libraries, so that the same seed always produces the same corpora
+ * on every machine.
+ */
+class corpus_generator {
+public:
+
+    /**
+     * Construct a corpus generator.
+     *
+     * @param seed Seed of the underlying pseudo-random generator.
+     */
+    corpus_generator(uint32_t seed);
+
+    /**
+     * Generate a uniformly random text over an alphabet of the given size.
+     * Alphabets of at most 26 letters consist of lower case letters starting
+     * from 'a', larger alphabets consist of consecutive byte values.
+     *
+     * @param n Length of the text.
+     * @param sigma Alphabet size; 2 <= sigma <= 256.
+     * @return Generated text.
+     */
+    std::string random(size_t n, unsigned sigma);
+
+    /**
+     * Generate a prefix of the infinite Fibonacci word over {a,b}.
+     *
+     * @param n Length of the text.
+     * @return Generated text.
+     */
+    std::string fibonacci(size_t n);
+
+    /**
+     * Generate a text repeating a random root of the given length over
+     * {a,b,c,d}.
+     *
+     * @param n Length of the text.
+     * @param period Length of the repeated root.
+     * @return Generated text.
+     */
+    std::string periodic(size_t n, size_t period);
+
+    /**
+     * Generate a prefix of the infinite Thue-Morse word over {a,b}. The word
+     * is overlap-free: it contains squares but no factor of the form axaxa.
+     *
+     * @param n Length of the text.
+     * @return Generated text.
+     */
+    std::string thue_morse(size_t n);
+
+    /**
+     * Generate a text consisting of alternating runs of letters a and b with
+     * uniformly random lengths.
+     *
+     * @param n Length of the text.
+     * @param max_run Maximum length of a run.
+     * @return Generated text.
+     */
+    std::string runs(size_t n, size_t max_run);
+
+    /**
+     * Generate a random root over {a,b,c,d} to be repeated with repeat().
+     *
+     * @param period Length of the root.
+     * @return Generated root.
+     */
+    std::string root(size_t period);
+
+    /**
+     * Repeat the given root.
+     *
+     * @param root Repeated root.
+     * @param n Length of the text.
+     * @return Prefix of length n of root repeated infinitely.
+     */
+    std::string repeat(const std::string& root, size_t n);
+
+    /**
+     * Substitute characters at distinct random positions with a different
+     * letter of {a,b,c,d}. Used for producing near-periodic texts and
+     * patterns with a controlled number of mismatches.
+     *
+     * @param s Source string.
+     * @param mismatches Number of substituted positions; clamped to the length
+     * of s.
+     * @return Modified string.
+     */
+    std::string mutate(std::string s, size_t mismatches);
+
+    /**
+     * Generate a natural-text-like text from an order-2 character level
+     * Markov model trained with a built-in English sample.
+     *
+     * @param n Length of the text.
+     * @return Generated text.
+     */
+    std::string markov(size_t n);
+
+    /**
+     * Pick a random substring of the given text.
+     *
+     * @param t Source text.
+     * @param m Length of the substring; clamped to the length of the text.
+     * @return Picked substring.
+     */
+    std::string substring(const std::string& t, size_t m);
+
+private:
+    /* Uniformly random number in [0,bound). */
+    size_t below(size_t bound);
+
+    std::mt19937_64 rng;
+};
+
+#endif
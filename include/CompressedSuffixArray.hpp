@@ -0,0 +1,392 @@
+#ifndef COMPRESSED_SUFFIX_ARRAY_HPP
+#define COMPRESSED_SUFFIX_ARRAY_HPP
+
+#include "SuffixArray.hpp"
+#include "Util.hpp"
+
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <algorithm>
+#include <type_traits>
+#include <cstdint>
+
+namespace rmatch {
+namespace detail {
+/*!
+    appends the Elias gamma code of \a x >= 1 to the bits of \a words at bit
+    \a pos and advances \a pos: as many zeros as x has bits after its highest
+    one bit, a one, and those bits of x
+    The bits past \a pos have to be zero.
+*/
+inline void gammaWrite(std::vector<BitBlock> & words, size_t & pos, uint64_t x) {
+    const size_t l = 63 - __builtin_clzll(x);
+    // one spare block keeps the reads of gammaRead() within the vector
+    const size_t need = (pos + 2*l + 1) / blockBits + 2;
+    if (words.size() < need) {
+        words.resize(std::max(need, 2*words.size()));
+    }
+    writeBits(words, pos + l, 1, 1);
+    pos += l + 1;
+    if (l) {
+        writeBits(words, pos, l, x);
+        pos += l;
+    }
+}
+
+/*!
+    reads the Elias gamma code at bit \a pos of \a words and advances \a pos
+*/
+inline uint64_t gammaRead(const std::vector<BitBlock> & words, size_t & pos) {
+    const size_t l = __builtin_ctzll(readBits(words, pos, blockBits));
+    pos += l + 1;
+    if (!l) {
+        return 1;
+    }
+    const uint64_t x = readBits(words, pos, l) | (uint64_t(1) << l);
+    pos += l;
+    return x;
+}
+}
+
+/*!
+    Compressed suffix array. The text and the suffix array are replaced by the
+    function Psi, which maps the rank of each suffix T[i..n) to the rank of the
+    suffix T[i+1..n), and by samples of the suffix array and its inverse.
+
+    Psi is increasing within the ranks of the suffixes starting with the same
+    symbol, so it is stored as Elias gamma coded differences, which take few
+    bits for compressible texts. Every psiBlock-th value is stored as it is.
+    The symbol starting a suffix is found from the ranks at which the
+    symbols change, and comparing a pattern to a suffix follows Psi from one
+    symbol of the suffix to the next.
+
+    The suffix array is sampled at the suffixes T[i..n) with i divisible by
+    the sample rate s. The position of any other suffix is found following
+    Psi to a sampled suffix in less than s steps, so s trades the speed of
+    reporting positions for the 4n/s bytes of the samples. The inverse suffix
+    array is sampled at the same positions, which allows extracting
+    substrings of the text.
+
+    Internally, rank 0 is the empty suffix T[n..n), which ends the walks
+    along Psi. The public ranks used by lowerBound() and upperBound() are
+    those of the SuffixArray class, which does not have the empty suffix.
+*/
+template<typename string_type, typename index_type = uint32_t>
+class CompressedSuffixArray {
+    public:
+    typedef typename string_type::value_type symbol_type;
+    typedef symbol_key<symbol_type> key;
+
+    /*!
+        number of values of Psi per block of differences
+    */
+    static const size_t psiBlock = 64;
+
+    /*!
+        builds the compressed suffix array of \a data sampling every
+        \a sampleRate-th suffix
+        The suffix array is constructed in full first and compressed after.
+    */
+    CompressedSuffixArray(const string_type & data, size_t sampleRate = 32)
+     : m_size(data.size()), m_rate(std::max<size_t>(sampleRate, 1)) {
+        typedef typename key::type key_type;
+        const size_t n = m_size;
+        std::vector<int> sa(n);
+        int err = detail::saisCompact(data.begin(), data.end(), sa,
+                std::integral_constant<int, sizeof(key_type)>());
+        if (err) {
+            throw std::runtime_error("Could not create suffix array. Error: " + std::to_string(err));
+        }
+
+        /*
+            the first symbols of the suffixes in rank order are sorted, so
+            the symbols and the ranks where they start are read off directly
+        */
+        for (size_t r = 0; r < n; ++r) {
+            const symbol_type c = data[sa[r]];
+            if (m_symbols.empty() || key::get(m_symbols.back()) != key::get(c)) {
+                m_symbols.push_back(c);
+                m_starts.push_back(r+1);
+            }
+        }
+        m_starts.push_back(n+1);
+
+        /*
+            the suffixes starting with c are ordered by the rank of the suffix
+            following c, so scanning the ranks in order fills each bucket of
+            Psi in increasing order
+        */
+        std::vector<index_type> psi(n+1);
+        std::vector<index_type> next(m_starts.begin(), m_starts.end()-1);
+        for (size_t r = 0; r <= n; ++r) {
+            const size_t p = r ? sa[r-1] : n;
+            if (p == 0) {
+                psi[0] = r;
+            } else {
+                psi[next[symbolCode(data[p-1])]++] = r;
+            }
+        }
+
+        buildSamples(sa);
+        std::vector<int>().swap(sa);
+        encodePsi(psi);
+    }
+
+    /*!
+        number of symbols in the text
+    */
+    size_t size() const {
+        return m_size;
+    }
+
+    /*!
+        memory used by the structure in bytes
+    */
+    size_t bytes() const {
+        return sizeof(*this)
+            + m_psiBits.capacity() * sizeof(BitBlock)
+            + m_psiHeads.capacity() * sizeof(index_type)
+            + m_psiPositions.capacity() * sizeof(size_t)
+            + m_sampled.bytes()
+            + m_saSamples.capacity() * sizeof(index_type)
+            + m_isaSamples.capacity() * sizeof(index_type)
+            + m_symbols.capacity() * sizeof(symbol_type)
+            + m_starts.capacity() * sizeof(index_type);
+    }
+
+    /*!
+        returns Psi of the internal rank \a r
+    */
+    index_type psi(size_t r) const {
+        const size_t b = r / psiBlock;
+        size_t v = m_psiHeads[b];
+        size_t pos = m_psiPositions[b];
+        for (size_t k = b * psiBlock; k < r; ++k) {
+            v += detail::gammaRead(m_psiBits, pos);
+            if (v > m_size) {
+                v -= m_size + 1;
+            }
+        }
+        return v;
+    }
+
+    /*!
+        returns the starting position of the suffix of public rank \a r
+    */
+    size_t locate(size_t r) const {
+        size_t i = r + 1, k = 0;
+        while (!m_sampled[i]) {
+            i = psi(i);
+            ++k;
+        }
+        return m_saSamples[m_sampled.rank(i)] - k;
+    }
+
+    /*!
+        returns the public rank of the suffix starting at position \a i < n
+    */
+    size_t inverse(size_t i) const {
+        size_t r = m_isaSamples[i / m_rate];
+        for (size_t k = i / m_rate * m_rate; k < i; ++k) {
+            r = psi(r);
+        }
+        return r - 1;
+    }
+
+    /*!
+        writes the symbols of the text from position \a i up to \a len
+        symbols to \a out
+    */
+    template <typename output_iterator>
+    output_iterator extract(size_t i, size_t len, output_iterator out) const {
+        if (i >= m_size) {
+            return out;
+        }
+        size_t r = inverse(i) + 1;
+        for (size_t k = 0; k < len && r; ++k) {
+            *out++ = m_symbols[bucket(r)];
+            r = psi(r);
+        }
+        return out;
+    }
+
+    /*!
+        returns the index in the suffix array for which
+        array[0...k] is a subarray for which
+        p = array[i], then data[p] < top
+    */
+    int lowerBound(const string_type & top) const {
+        return countLess(top) - 1;
+    }
+
+    /*!
+        returns the index in the suffix array for which
+        array[t...) is a subarray for which
+        p = array[i], then data[p] >= bottom
+    */
+    int upperBound(const string_type & bottom) const {
+        return countLess(bottom);
+    }
+
+    /*!
+        stores the starting positions of the suffixes which are
+        bigger or equal than \a bottom and smaller than \a top.
+    */
+    template <typename output_container>
+    void rangeQuery(const string_type & bottom, const string_type & top, output_container& positions) const {
+        int from = upperBound(bottom);
+        int to = lowerBound(top);
+        if (from > to) {
+            return;
+        }
+        positions.resize(to-from+1);
+        for (int i = 0; from+i <= to; ++i) {
+            positions[i] = locate(from+i);
+        }
+    }
+
+    /*!
+        returns the starting positions of the suffixes which are
+        bigger or equal than \a bottom and smaller than \a top.
+    */
+    std::vector<size_t> rangeQuery(const string_type & bottom, const string_type & top) const {
+        std::vector<size_t> positions;
+        rangeQuery(bottom,top,positions);
+        return positions;
+    }
+
+    private:
+    /*!
+        returns the index of the symbol starting the suffix of internal rank
+        \a r > 0
+    */
+    size_t bucket(size_t r) const {
+        return std::upper_bound(m_starts.begin(), m_starts.end(), r) - m_starts.begin() - 1;
+    }
+
+    /*!
+        returns the index of symbol \a c occurring in the text
+    */
+    size_t symbolCode(symbol_type c) const {
+        return std::lower_bound(m_symbols.begin(), m_symbols.end(), c,
+                [](const symbol_type & a, const symbol_type & b) {
+                    return key::get(a) < key::get(b);
+                }) - m_symbols.begin();
+    }
+
+    /*!
+        tells whether the suffix of internal rank \a r is smaller than \a p
+        The symbols of the suffix are visited following Psi.
+    */
+    bool less(size_t r, const string_type & p) const {
+        for (size_t j = 0; j < p.size(); ++j) {
+            // the suffix ended first
+            if (r == 0) {
+                return true;
+            }
+            const auto c = key::get(m_symbols[bucket(r)]);
+            const auto d = key::get(p[j]);
+            if (c != d) {
+                return c < d;
+            }
+            r = psi(r);
+        }
+        return false;
+    }
+
+    /*!
+        returns the number of suffixes smaller than \a p
+    */
+    int countLess(const string_type & p) const {
+        size_t l = 0, r = m_size;
+        while (l < r) {
+            const size_t mid = (l + r) / 2;
+            if (less(mid + 1, p)) {
+                l = mid + 1;
+            } else {
+                r = mid;
+            }
+        }
+        return l;
+    }
+
+    /*!
+        samples the suffix array at the positions divisible by the sample rate
+        and at the empty suffix, and the inverse suffix array at the same
+        positions
+    */
+    void buildSamples(const std::vector<int> & sa) {
+        const size_t n = m_size;
+        m_sampled = RankBitVector(n + 1);
+        m_isaSamples.resize((n + m_rate - 1) / m_rate);
+        for (size_t r = 0; r <= n; ++r) {
+            const size_t p = r ? sa[r-1] : n;
+            if (p % m_rate == 0 || p == n) {
+                m_sampled.set(r);
+                m_saSamples.push_back(p);
+            }
+            if (p % m_rate == 0 && p < n) {
+                m_isaSamples[p / m_rate] = r;
+            }
+        }
+        m_saSamples.shrink_to_fit();
+        m_sampled.buildRank();
+    }
+
+    /*!
+        encodes Psi as differences modulo n+1, which are positive as Psi is a
+        permutation and small within the buckets where Psi increases
+    */
+    void encodePsi(const std::vector<index_type> & psi) {
+        const size_t n = m_size;
+        size_t pos = 0;
+        m_psiBits.assign(2, 0);
+        for (size_t r = 0; r <= n; ++r) {
+            if (r % psiBlock == 0) {
+                m_psiHeads.push_back(psi[r]);
+                m_psiPositions.push_back(pos);
+            } else {
+                const size_t d = psi[r] > psi[r-1] ? psi[r] - psi[r-1] : psi[r] + n + 1 - psi[r-1];
+                detail::gammaWrite(m_psiBits, pos, d);
+            }
+        }
+        m_psiBits.resize(pos / blockBits + 2);
+        m_psiBits.shrink_to_fit();
+    }
+
+    /*!
+        text length and sample rate
+    */
+    size_t m_size;
+    size_t m_rate;
+
+    /*!
+        Elias gamma coded differences of Psi, the first value of each block
+        and the bit position of the differences of each block
+    */
+    std::vector<BitBlock> m_psiBits;
+    std::vector<index_type> m_psiHeads;
+    std::vector<size_t> m_psiPositions;
+
+    /*!
+        bit vector of the sampled ranks and the samples in rank order
+    */
+    RankBitVector m_sampled;
+    std::vector<index_type> m_saSamples;
+
+    /*!
+        ranks of the suffixes at the positions divisible by the sample rate
+    */
+    std::vector<index_type> m_isaSamples;
+
+    /*!
+        distinct symbols of the text in order and the first internal rank of
+        the suffixes starting with each of them followed by n+1
+    */
+    std::vector<symbol_type> m_symbols;
+    std::vector<index_type> m_starts;
+};
+}
+
+#endif // COMPRESSED_SUFFIX_ARRAY_HPP
@@ -72,26 +72,87 @@ void updateMS(const string_type & pattern, size_t & l, size_t & s, size_t & p)
 }
 
 /*!
-    returns a \a boost::dynamic_bitset of size \a text.length() where
+    maximum suffixes of all prefixes of a pattern precomputed for the O(m) space
+    mode of \a lowerBound
+    \a s[l], \a p[l] -> state of updateMS after extending the empty match by l characters
+    \a z[i] -> length of the longest common prefix of pattern and pattern[i..)
+    The states of the prefixes are the same for every text position, so looking
+    them up replaces the character comparisons of updateMS, and \a z answers the
+    periodicity check of the skip without comparing the pattern with itself.
+*/
+template<typename string_type>
+struct MaximumSuffixTable
+{
+    std::vector<size_t> s, p, z;
+
+    explicit MaximumSuffixTable(const string_type & pattern)
+        : s(pattern.size()+1), p(pattern.size()+1), z(pattern.size()+1)
+    {
+        const size_t m = pattern.size();
+        size_t l = 0, ms = 0, mp = 0;
+        while (l < m)
+        {
+            updateMS(pattern, l, ms, mp);
+            s[l] = ms;
+            p[l] = mp;
+        }
+        /*
+            z-array of the pattern with a window [zl,zr) of the rightmost match
+        */
+        z[0] = m;
+        size_t zl = 0, zr = 0;
+        for (size_t i = 1; i < m; ++i)
+        {
+            size_t q = i < zr ? std::min(z[i-zl], zr-i) : 0;
+            while (i+q < m && pattern[q] == pattern[i+q]) ++q;
+            z[i] = q;
+            if (i+q > zr)
+            {
+                zl = i;
+                zr = i+q;
+            }
+        }
+    }
+};
+
+/*!
+    returns a \a boost::dynamic_bitset of size \a text.size() where
     bit[i] = 1 then text[i...) < pattern
     bit[i] = 0 else
+    If \a table is given, the maximum suffixes are looked up from it in O(m)
+    space instead of being recomputed in O(1) space.
+    The bits are kept in blocks while scanning, so that the bits copied on a
+    skip are moved a block at a time.
 */
 template<typename string_type>
-boost::dynamic_bitset<> lowerBound(const string_type & text, const string_type & pattern)
+boost::dynamic_bitset<> lowerBound(const string_type & text, const string_type & pattern,
+        const MaximumSuffixTable<string_type> * table)
 {
-    boost::dynamic_bitset<> bits = boost::dynamic_bitset<>(text.length());
+    const size_t n = text.size();
+    std::vector<BitBlock> words((n + blockBits - 1) / blockBits);
     size_t i=0, l = 0, p = 0, s = 0, j = 0;
     size_t imax = 0, lmax = 0, pmax = 0, smax = 0, h = 0;
-    while (i < text.length())
+    while (i < text.size())
     {
-        while (i+l < text.length() && l < pattern.length() && text[i+l]==pattern[l])
+        while (i+l < text.size() && l < pattern.size() && text[i+l]==pattern[l])
         {
             /*
                 update the maximum suffix and the maximum pariod of it
+                the table holds the next state if the current one is the state
+                of the same prefix reached from the empty match
             */
-            updateMS(pattern, l, s, p);
+            if (table && (l == 0 || (s == table->s[l] && p == table->p[l])))
+            {
+                ++l;
+                s = table->s[l];
+                p = table->p[l];
+            }
+            else
+            {
+                updateMS(pattern, l, s, p);
+            }
         }
-        if (l < pattern.length() && (i+l==text.length() || text[i+l] < pattern[l]))
+        if (l < pattern.size() && (i+l==text.size() || text[i+l] < pattern[l]))
         {
             /*
                 we do not have a match
@@ -99,7 +160,7 @@ boost::dynamic_bitset<> lowerBound(const string_type & text, const string_type &
                 if we have reached the length of the text, then we "compare" with the empty string which is always smaller
                 => we set the bit to 1
             */
-            bits[i] = 1;
+            words[i / blockBits] |= BitBlock(1) << (i % blockBits);
         }
         j = imax;
         if (l > lmax)
@@ -109,14 +170,15 @@ boost::dynamic_bitset<> lowerBound(const string_type & text, const string_type &
             std::swap(p,pmax);
             imax = i;
         }
-        if ((0 < p && p <= l/3) && std::equal(pattern.begin(), pattern.begin()+s, pattern.begin()+p))
+        if ((0 < p && p <= l/3) && (table ? table->z[p] >= s :
+                    std::equal(pattern.begin(), pattern.begin()+s, pattern.begin()+p)))
         {
             /*
                 we make a skip but we must copy the bit set in the range
                 we are skipping a period
                 we just have to copy what we have set initially.
             */
-            for (int f = 1; f < p; ++f) bits[i+f] = bits[j+f];
+            copyBits(words, i+1, j+1, std::min(p, n-i) - 1);
             i = i+p;
             l = l-p;
         }
@@ -126,24 +188,57 @@ boost::dynamic_bitset<> lowerBound(const string_type & text, const string_type &
                 we make a skip but we must copy the bit set in the range
             */
             h = l/3 + 1;
-            for (int f = 1; f < h; ++f) bits[i+f] = bits[j+f];
+            if (h > 1) copyBits(words, i+1, j+1, std::min(h, n-i) - 1);
             i += h;
             l = 0, s = 0, p = 0;
         }
     }
-    return std::move(bits);
+    boost::dynamic_bitset<> bits(words.begin(), words.end());
+    bits.resize(n);
+    return bits;
+}
+
+/*!
+    returns a \a boost::dynamic_bitset of size \a text.size() where
+    bit[i] = 1 then text[i...) < pattern
+    bit[i] = 0 else
+    Uses O(1) extra space.
+*/
+template<typename string_type>
+boost::dynamic_bitset<> lowerBound(const string_type & text, const string_type & pattern)
+{
+    return lowerBound(text, pattern, static_cast<const MaximumSuffixTable<string_type> *>(nullptr));
+}
+
+/*!
+    returns a \a boost::dynamic_bitset of size \a text.size() where
+    bit[i] = 1 then text[i...) < pattern
+    bit[i] = 0 else
+    Uses the precomputed maximum suffixes in \a table, which must have been
+    built from \a pattern.
+*/
+template<typename string_type>
+boost::dynamic_bitset<> lowerBound(const string_type & text, const string_type & pattern,
+        const MaximumSuffixTable<string_type> & table)
+{
+    return lowerBound(text, pattern, &table);
 }
 
 /*!
     puts the starting positions of all suffixes in \a text which are lexicographically
     in the range [low,top) in \a positions
+    If \a precompute is true, the maximum suffixes of the patterns are
+    precomputed in O(m) space, which saves work on every text position.
 */
 template<typename string_type, typename output_container>
-void stringRangeMatch(const string_type & text, const string_type & low, const string_type & top, output_container& positions)
+void stringRangeMatch(const string_type & text, const string_type & low, const string_type & top, output_container& positions,
+        bool precompute = false)
 {
     using namespace std;
-    boost::dynamic_bitset<> lowbits = lowerBound(text,low);
-    boost::dynamic_bitset<> topbits = lowerBound(text,top);
+    boost::dynamic_bitset<> lowbits = precompute ?
+        lowerBound(text,low,MaximumSuffixTable<string_type>(low)) : lowerBound(text,low);
+    boost::dynamic_bitset<> topbits = precompute ?
+        lowerBound(text,top,MaximumSuffixTable<string_type>(top)) : lowerBound(text,top);
     rmatch::retrieveRangeIndices(lowbits,topbits,positions);
 }
 
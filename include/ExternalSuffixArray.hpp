@@ -0,0 +1,463 @@
+#ifndef EXTERNAL_SUFFIX_ARRAY_HPP
+#define EXTERNAL_SUFFIX_ARRAY_HPP
+
+#include "SuffixArray.hpp"
+#include "match_length.hpp"
+#include "suffix_splitters.hpp"
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <functional>
+#include <stdexcept>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace rmatch {
+namespace detail {
+/*!
+    read-only memory mapping of a whole file
+*/
+class MappedFile {
+    public:
+    explicit MappedFile(const std::string & path) : m_data(nullptr), m_size(0) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Could not open " + path);
+        }
+        struct stat st;
+        if (fstat(fd, &st) < 0) {
+            close(fd);
+            throw std::runtime_error("Could not stat " + path);
+        }
+        m_size = st.st_size;
+        if (m_size) {
+            void *p = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+            if (p == MAP_FAILED) {
+                close(fd);
+                throw std::runtime_error("Could not map " + path);
+            }
+            m_data = static_cast<const char*>(p);
+        }
+        close(fd);
+    }
+
+    ~MappedFile() {
+        if (m_data) {
+            munmap(const_cast<char*>(m_data), m_size);
+        }
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile & operator=(const MappedFile &) = delete;
+
+    const char * data() const {
+        return m_data;
+    }
+
+    size_t size() const {
+        return m_size;
+    }
+
+    private:
+    const char * m_data;
+    size_t m_size;
+};
+
+/*!
+    temporary file of suffix positions created with mkstemp in a directory and
+    removed when the object is destroyed
+*/
+class PositionFile {
+    public:
+    explicit PositionFile(const std::string & dir) : m_count(0) {
+        std::vector<char> name(dir.begin(), dir.end());
+        const char suffix[] = "/rmatch-sa-XXXXXX";
+        name.insert(name.end(), suffix, suffix + sizeof(suffix));
+        int fd = mkstemp(name.data());
+        if (fd < 0) {
+            throw std::runtime_error("Could not create a temporary file in " + dir);
+        }
+        m_path = name.data();
+        m_file = fdopen(fd, "w+b");
+        if (!m_file) {
+            close(fd);
+            unlink(m_path.c_str());
+            throw std::runtime_error("Could not open " + m_path);
+        }
+    }
+
+    ~PositionFile() {
+        fclose(m_file);
+        unlink(m_path.c_str());
+    }
+
+    PositionFile(const PositionFile &) = delete;
+    PositionFile & operator=(const PositionFile &) = delete;
+
+    /*!
+        sets the size of the write buffer, which must be done before any
+        other operation
+    */
+    void buffer(size_t bytes) {
+        setvbuf(m_file, nullptr, _IOFBF, bytes);
+    }
+
+    void write(uint64_t p) {
+        if (fwrite(&p, sizeof(p), 1, m_file) != 1) {
+            throw std::runtime_error("Could not write " + m_path);
+        }
+        ++m_count;
+    }
+
+    /*!
+        calls \a f for every position written so far
+    */
+    template <typename function>
+    void forEach(function f) {
+        rewind(m_file);
+        uint64_t buf[4096];
+        size_t left = m_count;
+        while (left) {
+            const size_t c = fread(buf, sizeof(uint64_t), std::min<size_t>(left, 4096), m_file);
+            if (!c) {
+                throw std::runtime_error("Could not read " + m_path);
+            }
+            for (size_t i = 0; i < c; ++i) {
+                f(buf[i]);
+            }
+            left -= c;
+        }
+    }
+
+    size_t count() const {
+        return m_count;
+    }
+
+    private:
+    std::string m_path;
+    FILE * m_file;
+    size_t m_count;
+};
+
+/*!
+    header of a suffix array file, followed by the n positions of the suffixes
+    in lexicographic order as unsigned integers of the given width in native
+    byte order
+*/
+struct SuffixArrayFileHeader {
+    char magic[8];
+    uint64_t width;
+    uint64_t size;
+};
+
+const char suffixArrayMagic[8] = { 'R', 'M', 'A', 'T', 'C', 'H', 'S', 'A' };
+
+/*!
+    writes the sorted suffix positions into a suffix array file
+*/
+class SuffixArrayWriter {
+    public:
+    SuffixArrayWriter(const std::string & path, size_t n) : m_path(path), m_written(0), m_size(n) {
+        m_file = fopen(path.c_str(), "wb");
+        if (!m_file) {
+            throw std::runtime_error("Could not create " + path);
+        }
+        SuffixArrayFileHeader h;
+        std::memcpy(h.magic, suffixArrayMagic, sizeof(h.magic));
+        h.width = n <= UINT32_MAX ? 4 : 8;
+        h.size = n;
+        m_width = h.width;
+        put(&h, sizeof(h));
+    }
+
+    ~SuffixArrayWriter() {
+        if (m_file) {
+            fclose(m_file);
+        }
+    }
+
+    void write(uint64_t p) {
+        if (m_width == 4) {
+            const uint32_t v = p;
+            put(&v, sizeof(v));
+        } else {
+            put(&p, sizeof(p));
+        }
+        ++m_written;
+    }
+
+    void finish() {
+        FILE * f = m_file;
+        m_file = nullptr;
+        if (m_written != m_size || fclose(f) != 0) {
+            throw std::runtime_error("Could not write " + m_path);
+        }
+    }
+
+    private:
+    void put(const void * p, size_t bytes) {
+        if (fwrite(p, 1, bytes, m_file) != bytes) {
+            throw std::runtime_error("Could not write " + m_path);
+        }
+    }
+
+    std::string m_path;
+    FILE * m_file;
+    size_t m_width;
+    size_t m_written;
+    size_t m_size;
+};
+
+/*!
+    Blockwise suffix sorting in bounded memory. The suffixes are distributed
+    into buckets by splitter strings sampled from the text, each bucket is
+    written to a temporary file, and buckets small enough to fit into the
+    memory budget are sorted in memory and appended to the output in order.
+    Buckets that are still too large are split again with longer splitters.
+*/
+class ExternalSuffixSorter {
+    public:
+    ExternalSuffixSorter(const char * t, size_t n, size_t capacity, size_t bufferBytes,
+            const std::string & tempDir, SuffixArrayWriter & out)
+     : m_text(t), m_size(n), m_capacity(std::max<size_t>(capacity, 1)),
+       m_bufferBytes(bufferBytes), m_tempDir(tempDir), m_out(out) {}
+
+    /*!
+        function receiving suffix positions, and function calling its
+        argument for each position of a set of suffixes
+    */
+    typedef std::function<void(uint64_t)> Sink;
+    typedef std::function<void(const Sink &)> Source;
+
+    /*!
+        sorts the suffixes listed by \a source, which calls its argument for
+        each of the \a count positions, comparing prefixes of \a prefix
+        symbols for splitting
+    */
+    void sort(const Source & source, size_t count, size_t prefix) {
+        if (count <= m_capacity) {
+            std::vector<uint64_t> positions;
+            positions.reserve(count);
+            source([&](uint64_t p) { positions.push_back(p); });
+            const char * t = m_text;
+            const size_t n = m_size;
+            std::sort(positions.begin(), positions.end(), [=](uint64_t a, uint64_t b) {
+                return suffix_less(t, n, a, b);
+            });
+            for (uint64_t p : positions) {
+                m_out.write(p);
+            }
+            return;
+        }
+
+        std::vector<std::string> splitters = chooseSplitters(source, count, prefix);
+        std::vector<std::unique_ptr<PositionFile>> buckets;
+        for (size_t i = 0; i <= splitters.size(); ++i) {
+            buckets.emplace_back(new PositionFile(m_tempDir));
+            buckets.back()->buffer(m_bufferBytes / (splitters.size() + 1));
+        }
+        source([&](uint64_t p) {
+            const size_t b = std::upper_bound(splitters.begin(), splitters.end(), p,
+                    [&](uint64_t q, const std::string & s) {
+                        return suffix_less(m_text, m_size, q, s);
+                    }) - splitters.begin();
+            buckets[b]->write(p);
+        });
+        std::vector<std::string>().swap(splitters);
+
+        for (auto & b : buckets) {
+            PositionFile & f = *b;
+            // a bucket that did not shrink is split with longer prefixes
+            const size_t longer = f.count() == count ? prefix * 2 : prefix;
+            sort([&](const Sink & g) { f.forEach(g); }, f.count(), longer);
+            b.reset();
+        }
+    }
+
+    private:
+    /*!
+        chooses splitters from the prefixes of a sample of the suffixes so
+        that the buckets are expected to hold half the capacity
+    */
+    std::vector<std::string> chooseSplitters(const Source & source, size_t count, size_t prefix) {
+        const size_t buckets = std::min<size_t>(2 * count / m_capacity + 1, maxBuckets);
+        return sample_splitters(m_text, m_size, source, count, buckets, m_bufferBytes, prefix);
+    }
+
+    /*!
+        limit of the number of buckets split at once, which bounds the number
+        of temporary files open
+    */
+    static const size_t maxBuckets = 128;
+
+    const char * m_text;
+    size_t m_size;
+    size_t m_capacity;
+    size_t m_bufferBytes;
+    std::string m_tempDir;
+    SuffixArrayWriter & m_out;
+};
+}
+
+/*!
+    Constructs the suffix array of the text in the file \a textPath into the
+    suffix array file \a indexPath using at most about \a memoryBudget bytes
+    of memory besides the memory mapped text.
+
+    A text whose suffix array fits into the budget is sorted in memory with
+    SAIS. Otherwise the suffixes are distributed into buckets by splitters
+    sampled from the text, the buckets are written to temporary files in
+    \a tempDir, and each bucket is sorted in memory by comparing its suffixes.
+    Half of the budget holds the bucket being sorted and the rest the write
+    buffers of the buckets.
+*/
+inline void buildSuffixArrayFile(const std::string & textPath, const std::string & indexPath,
+        size_t memoryBudget = size_t(1) << 30, const std::string & tempDir = "/tmp") {
+    detail::MappedFile text(textPath);
+    const size_t n = text.size();
+    detail::SuffixArrayWriter out(indexPath, n);
+    if (n * sizeof(int) <= memoryBudget && n < size_t(INT32_MAX)) {
+        std::vector<int> sa(n);
+        int err = saisxx(detail::sais_key_iterator<const char*>(text.data()), sa.begin(), static_cast<int>(n));
+        if (err) {
+            throw std::runtime_error("Could not create suffix array. Error: " + std::to_string(err));
+        }
+        for (int p : sa) {
+            out.write(p);
+        }
+    } else {
+        detail::ExternalSuffixSorter sorter(text.data(), n, memoryBudget / 2 / sizeof(uint64_t),
+                memoryBudget / 2, tempDir, out);
+        sorter.sort([n](const detail::ExternalSuffixSorter::Sink & f) {
+            for (size_t i = 0; i < n; ++i) {
+                f(i);
+            }
+        }, n, 16);
+    }
+    out.finish();
+}
+
+/*!
+    Suffix array stored in a file written by buildSuffixArrayFile(). Both the
+    text and the suffix array are memory mapped, so only the pages touched by
+    the binary searches are read. It supports the range search of the
+    SuffixArray class.
+*/
+class DiskSuffixArray {
+    public:
+    DiskSuffixArray(const std::string & textPath, const std::string & indexPath)
+     : m_text(textPath), m_index(indexPath) {
+        detail::SuffixArrayFileHeader h;
+        if (m_index.size() < sizeof(h)) {
+            throw std::runtime_error("Not a suffix array file: " + indexPath);
+        }
+        std::memcpy(&h, m_index.data(), sizeof(h));
+        if (std::memcmp(h.magic, detail::suffixArrayMagic, sizeof(h.magic)) ||
+                (h.width != 4 && h.width != 8) ||
+                h.size != m_text.size() ||
+                m_index.size() != sizeof(h) + h.size * h.width) {
+            throw std::runtime_error("Not a suffix array of " + textPath + ": " + indexPath);
+        }
+        m_width = h.width;
+        m_entries = m_index.data() + sizeof(h);
+    }
+
+    /*!
+        number of suffixes
+    */
+    size_t size() const {
+        return m_text.size();
+    }
+
+    /*!
+        position of the suffix of rank \a i
+    */
+    size_t operator[](size_t i) const {
+        if (m_width == 4) {
+            uint32_t v;
+            std::memcpy(&v, m_entries + 4 * i, 4);
+            return v;
+        }
+        uint64_t v;
+        std::memcpy(&v, m_entries + 8 * i, 8);
+        return v;
+    }
+
+    /*!
+        returns the index in the suffix array for which
+        array[0...k] is a subarray for which
+        p = array[i], then data[p] < top
+    */
+    ptrdiff_t lowerBound(const std::string & top) const {
+        return countLess(top) - 1;
+    }
+
+    /*!
+        returns the index in the suffix array for which
+        array[t...) is a subarray for which
+        p = array[i], then data[p] >= bottom
+    */
+    ptrdiff_t upperBound(const std::string & bottom) const {
+        return countLess(bottom);
+    }
+
+    /*!
+        stores the starting positions of the suffixes which are
+        bigger or equal than \a bottom and smaller than \a top.
+    */
+    template <typename output_container>
+    void rangeQuery(const std::string & bottom, const std::string & top, output_container& positions) const {
+        ptrdiff_t from = upperBound(bottom);
+        ptrdiff_t to = lowerBound(top);
+        if (from > to) {
+            return;
+        }
+        positions.resize(to-from+1);
+        for (ptrdiff_t i = 0; from+i <= to; ++i) {
+            positions[i] = (*this)[from+i];
+        }
+    }
+
+    /*!
+        returns the starting positions of the suffixes which are
+        bigger or equal than \a bottom and smaller than \a top.
+    */
+    std::vector<size_t> rangeQuery(const std::string & bottom, const std::string & top) const {
+        std::vector<size_t> positions;
+        rangeQuery(bottom,top,positions);
+        return positions;
+    }
+
+    private:
+    /*!
+        returns the number of suffixes smaller than \a p
+    */
+    ptrdiff_t countLess(const std::string & p) const {
+        size_t l = 0, r = size();
+        while (l < r) {
+            const size_t mid = (l + r) / 2;
+            if (detail::suffix_less(m_text.data(), size(), (*this)[mid], p)) {
+                l = mid + 1;
+            } else {
+                r = mid;
+            }
+        }
+        return l;
+    }
+
+    detail::MappedFile m_text;
+    detail::MappedFile m_index;
+    size_t m_width;
+    const char * m_entries;
+};
+}
+
+#endif // EXTERNAL_SUFFIX_ARRAY_HPP
@@ -0,0 +1,310 @@
+#ifndef GENERALIZED_SUFFIX_ARRAY_HPP
+#define GENERALIZED_SUFFIX_ARRAY_HPP
+
+#include "sais.hxx"
+#include "Util.hpp"
+#include "SuffixArray.hpp"
+
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <algorithm>
+#include <limits>
+#include <cstdint>
+
+namespace rmatch {
+/*!
+    suffix of a document: the document index and the offset of the suffix
+    within the document
+*/
+struct DocumentPosition {
+    size_t doc;
+    size_t offset;
+};
+
+/*!
+    Generalized suffix array of a collection of documents of characters.
+
+    The documents are concatenated with a separator after each of them. The
+    characters are stored as 16-bit codes 1,...,256 ordered like the
+    characters, and the separators as code 0, which is smaller than any
+    character. A suffix therefore compares with a pattern as if it ended at
+    the end of its document, and the separator suffixes, which stand for the
+    empty suffixes of the documents, are the first D ranks of the suffix
+    array of D documents, before all the real suffixes.
+
+    The document of a text position is found by rank on a bit vector of the
+    document starts. For listing the distinct documents of a range without
+    visiting every suffix, each rank also stores its document and the
+    previous rank of the same document, whose range minima locate the first
+    suffix of every document in a range (Muthukrishnan's document listing).
+    The sorted ranks of the suffixes of each document give the number of
+    suffixes of a document in a range with two binary searches.
+*/
+template<typename string_type = std::string>
+class GeneralizedSuffixArray {
+    public:
+    /*!
+        builds the suffix array of the documents in the container \a docs
+    */
+    template<typename container>
+    explicit GeneralizedSuffixArray(const container & docs) {
+        size_t n = 0;
+        for (const auto & d : docs) {
+            n += d.size() + 1;
+        }
+        if (n >= size_t(std::numeric_limits<int>::max())) {
+            throw std::runtime_error("Documents are too large for a generalized suffix array");
+        }
+        m_text.reserve(n);
+        m_docStarts = RankBitVector(n);
+        for (const auto & d : docs) {
+            m_docStarts.set(m_text.size());
+            m_starts.push_back(m_text.size());
+            for (auto c : d) {
+                m_text.push_back(code(c));
+            }
+            m_text.push_back(0);
+        }
+        m_starts.push_back(n);
+        m_docStarts.buildRank();
+
+        m_array.resize(n);
+        int err = saisxx(m_text.begin(), m_array.begin(), static_cast<int>(n), 257);
+        if (err) {
+            throw std::runtime_error("Could not create suffix array. Error: " + std::to_string(err));
+        }
+        buildDocuments();
+    }
+
+    /*!
+        number of documents
+    */
+    size_t documents() const {
+        return m_starts.size() - 1;
+    }
+
+    /*!
+        number of suffixes, which is the total length of the documents
+    */
+    size_t size() const {
+        return m_array.size() - documents();
+    }
+
+    /*!
+        document and offset of the suffix of rank \a i
+    */
+    DocumentPosition operator[](size_t i) const {
+        return position(m_array[documents() + i]);
+    }
+
+    /*!
+        returns the index in the suffix array for which
+        array[0...k] is a subarray for which
+        p = array[i], then data[p] < top
+    */
+    int lowerBound(const string_type & top) const {
+        return countLess(top) - 1;
+    }
+
+    /*!
+        returns the index in the suffix array for which
+        array[t...) is a subarray for which
+        p = array[i], then data[p] >= bottom
+    */
+    int upperBound(const string_type & bottom) const {
+        return countLess(bottom);
+    }
+
+    /*!
+        stores the documents and offsets of the suffixes which are
+        bigger or equal than \a bottom and smaller than \a top.
+    */
+    template <typename output_container>
+    void rangeQuery(const string_type & bottom, const string_type & top, output_container& positions) const {
+        int from = upperBound(bottom);
+        int to = lowerBound(top);
+        if (from > to) {
+            return;
+        }
+        positions.resize(to-from+1);
+        for (int i = 0; from+i <= to; ++i) {
+            positions[i] = (*this)[from+i];
+        }
+    }
+
+    /*!
+        returns the documents and offsets of the suffixes which are
+        bigger or equal than \a bottom and smaller than \a top.
+    */
+    std::vector<DocumentPosition> rangeQuery(const string_type & bottom, const string_type & top) const {
+        std::vector<DocumentPosition> positions;
+        rangeQuery(bottom,top,positions);
+        return positions;
+    }
+
+    /*!
+        returns the number of suffixes which are bigger or equal than
+        \a bottom and smaller than \a top
+    */
+    size_t count(const string_type & bottom, const string_type & top) const {
+        return std::max(lowerBound(top) - upperBound(bottom) + 1, 0);
+    }
+
+    /*!
+        returns the documents having suffixes which are bigger or equal
+        than \a bottom and smaller than \a top in increasing order
+        The time depends on the number of documents found, not the number of
+        suffixes.
+    */
+    std::vector<size_t> distinctDocuments(const string_type & bottom, const string_type & top) const {
+        std::vector<size_t> docs;
+        const int from = upperBound(bottom), to = lowerBound(top);
+        if (from > to) {
+            return docs;
+        }
+        /*
+            the first suffix of a document in [from,to] has its previous
+            suffix of the same document before from, and it is the one with
+            the smallest previous rank in any subrange containing it
+        */
+        std::vector<std::pair<int, int> > stack(1, std::make_pair(from, to));
+        while (!stack.empty()) {
+            const int a = stack.back().first, b = stack.back().second;
+            stack.pop_back();
+            if (a > b) {
+                continue;
+            }
+            const int k = m_rmq.minimum(m_prev, a, b);
+            if (m_prev[k] >= from) {
+                continue;
+            }
+            docs.push_back(m_docArray[k]);
+            stack.push_back(std::make_pair(a, k - 1));
+            stack.push_back(std::make_pair(k + 1, b));
+        }
+        std::sort(docs.begin(), docs.end());
+        return docs;
+    }
+
+    /*!
+        returns the number of suffixes bigger or equal than \a bottom and
+        smaller than \a top in each document that has any, as pairs of
+        document and count in increasing order of the documents
+    */
+    std::vector<std::pair<size_t, size_t> > documentCounts(const string_type & bottom, const string_type & top) const {
+        std::vector<std::pair<size_t, size_t> > counts;
+        const int from = upperBound(bottom), to = lowerBound(top);
+        for (size_t d : distinctDocuments(bottom, top)) {
+            const auto b = m_docRanks.begin() + m_docRankStarts[d];
+            const auto e = m_docRanks.begin() + m_docRankStarts[d+1];
+            counts.push_back(std::make_pair(d, std::upper_bound(b, e, to) - std::lower_bound(b, e, from)));
+        }
+        return counts;
+    }
+
+    /*!
+        memory used by the structure in bytes
+    */
+    size_t bytes() const {
+        return sizeof(*this)
+            + m_text.capacity() * sizeof(uint16_t)
+            + m_array.capacity() * sizeof(int)
+            + m_docStarts.bytes()
+            + m_starts.capacity() * sizeof(size_t)
+            + m_docArray.capacity() * sizeof(uint32_t)
+            + m_prev.capacity() * sizeof(int)
+            + m_docRanks.capacity() * sizeof(int)
+            + m_docRankStarts.capacity() * sizeof(size_t)
+            + m_rmq.bytes();
+    }
+
+    private:
+    /*!
+        code of character \a c ordered like the characters
+    */
+    static uint16_t code(char c) {
+        return static_cast<uint16_t>(static_cast<int>(c) - std::numeric_limits<char>::min() + 1);
+    }
+
+    DocumentPosition position(size_t p) const {
+        const size_t d = m_docStarts.rank(p + 1) - 1;
+        return DocumentPosition{d, p - m_starts[d]};
+    }
+
+    /*!
+        returns the number of real suffixes smaller than \a p
+    */
+    int countLess(const string_type & p) const {
+        std::vector<uint16_t> codes;
+        codes.reserve(p.size());
+        for (auto c : p) {
+            codes.push_back(code(c));
+        }
+        // a separator is smaller than any character of the pattern
+        return detail::countCutSuffixesLess<symbol_key<uint16_t> >(m_text.begin(), 0, m_text.size(),
+                m_array.begin() + documents(), m_array.end(), codes);
+    }
+
+    /*!
+        fills the document of each rank, the previous rank of the same
+        document and the ranks of each document
+    */
+    void buildDocuments() {
+        const size_t d = documents(), n = size();
+        m_docArray.resize(n);
+        m_prev.resize(n);
+        m_docRankStarts.assign(d + 1, 0);
+        std::vector<int> last(d, -1);
+        for (size_t i = 0; i < n; ++i) {
+            const size_t doc = position(m_array[d + i]).doc;
+            m_docArray[i] = doc;
+            m_prev[i] = last[doc];
+            last[doc] = i;
+            ++m_docRankStarts[doc + 1];
+        }
+        for (size_t k = 0; k < d; ++k) {
+            m_docRankStarts[k + 1] += m_docRankStarts[k];
+        }
+        m_docRanks.resize(n);
+        std::vector<size_t> next(m_docRankStarts.begin(), m_docRankStarts.end() - 1);
+        for (size_t i = 0; i < n; ++i) {
+            m_docRanks[next[m_docArray[i]]++] = i;
+        }
+        m_rmq = RangeMinimum(m_prev);
+    }
+
+    /*!
+        codes of the concatenated documents and their suffix array
+    */
+    std::vector<uint16_t> m_text;
+    std::vector<int> m_array;
+
+    /*!
+        bit vector of the document start positions and the start positions
+        followed by the length of the text
+    */
+    RankBitVector m_docStarts;
+    std::vector<size_t> m_starts;
+
+    /*!
+        document and previous rank of the same document, or -1, of the real
+        suffixes in rank order
+    */
+    std::vector<uint32_t> m_docArray;
+    std::vector<int> m_prev;
+
+    /*!
+        ranks of the suffixes of each document in increasing order
+    */
+    std::vector<int> m_docRanks;
+    std::vector<size_t> m_docRankStarts;
+
+    /*!
+        range minima of the previous ranks
+    */
+    RangeMinimum m_rmq;
+};
+}
+
+#endif // GENERALIZED_SUFFIX_ARRAY_HPP
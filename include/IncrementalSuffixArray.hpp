@@ -0,0 +1,233 @@
+#ifndef INCREMENTAL_SUFFIX_ARRAY_HPP
+#define INCREMENTAL_SUFFIX_ARRAY_HPP
+
+#include "SuffixArray.hpp"
+#include "alphabet.hpp"
+
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+
+namespace rmatch {
+/*!
+    Suffix array of a text that grows by appending, kept as a log of suffix
+    arrays of consecutive segments of the text.
+
+    Appending builds the suffix array of the appended segment only. A
+    segment sorts its suffixes as if the text ended at the end of the
+    segment, so the arrays of the older segments stay valid while the text
+    grows. To keep the number of segments logarithmic, the newest segment is
+    merged with the one before it as long as it is at least half its size,
+    like the levels of a log-structured merge tree. Each symbol is thus
+    sorted O(log n) times in total instead of once per append.
+
+    A range query searches every segment. The order of a suffix and a
+    pattern of length m is decided by the first m symbols of the suffix, so
+    the suffixes of a segment at least m symbols before its end are found by
+    the search of the segment. The less than m suffixes closer to the end of
+    each older segment continue into the following segments and are compared
+    with the patterns directly.
+*/
+template<typename string_type = std::string>
+class IncrementalSuffixArray {
+    public:
+    typedef typename string_type::value_type symbol_type;
+    typedef symbol_key<symbol_type> key;
+
+    /*!
+        creates an empty suffix array
+    */
+    IncrementalSuffixArray() {}
+
+    /*!
+        creates the suffix array of \a data as a single segment
+    */
+    explicit IncrementalSuffixArray(const string_type & data) {
+        append(data);
+    }
+
+    /*!
+        appends \a data to the text and sorts its suffixes
+    */
+    void append(const string_type & data) {
+        if (data.size() == 0) {
+            return;
+        }
+        if (data.size() >= size_t(std::numeric_limits<int>::max())) {
+            throw std::runtime_error("Appended text is too large for a suffix array segment");
+        }
+        const size_t start = m_data.size();
+        m_data.insert(m_data.end(), data.begin(), data.end());
+        m_segments.push_back(Segment());
+        m_segments.back().start = start;
+        m_segments.back().end = m_data.size();
+        sortSegment(m_segments.back());
+        compact();
+    }
+
+    /*!
+        length of the text
+    */
+    size_t size() const {
+        return m_data.size();
+    }
+
+    /*!
+        number of segments the suffixes are sorted in
+    */
+    size_t segments() const {
+        return m_segments.size();
+    }
+
+    /*!
+        the text
+    */
+    const string_type & data() const {
+        return m_data;
+    }
+
+    /*!
+        stores the starting positions of the suffixes which are
+        bigger or equal than \a bottom and smaller than \a top.
+        The positions of each segment are in the order of the suffixes, and
+        the segments in the order of the text.
+    */
+    template <typename output_container>
+    void rangeQuery(const string_type & bottom, const string_type & top, output_container& positions) const {
+        const size_t m = std::max(bottom.size(), top.size());
+        positions.clear();
+        for (size_t s = 0; s < m_segments.size(); ++s) {
+            const Segment & seg = m_segments[s];
+            // only the last segment ends where the text ends
+            const size_t tail = s + 1 < m_segments.size() && m > 0 ?
+                seg.end - std::min(seg.end - seg.start, m - 1) : seg.end;
+            const int from = countLess(seg, bottom);
+            const int to = countLess(seg, top);
+            for (int r = from; r < to; ++r) {
+                const size_t p = seg.start + seg.array[r];
+                if (p < tail) {
+                    positions.push_back(p);
+                }
+            }
+            for (size_t p = tail; p < seg.end; ++p) {
+                if (!less(p, bottom) && less(p, top)) {
+                    positions.push_back(p);
+                }
+            }
+        }
+    }
+
+    /*!
+        returns the starting positions of the suffixes which are
+        bigger or equal than \a bottom and smaller than \a top.
+    */
+    std::vector<size_t> rangeQuery(const string_type & bottom, const string_type & top) const {
+        std::vector<size_t> positions;
+        rangeQuery(bottom,top,positions);
+        return positions;
+    }
+
+    /*!
+        returns the number of suffixes which are bigger or equal than
+        \a bottom and smaller than \a top
+    */
+    size_t count(const string_type & bottom, const string_type & top) const {
+        const size_t m = std::max(bottom.size(), top.size());
+        size_t c = 0;
+        for (size_t s = 0; s < m_segments.size(); ++s) {
+            const Segment & seg = m_segments[s];
+            const int from = countLess(seg, bottom);
+            const int to = countLess(seg, top);
+            c += std::max(to - from, 0);
+            if (s + 1 == m_segments.size() || m == 0) {
+                continue;
+            }
+            // the tail suffixes are counted by comparing them with the
+            // patterns within the segment and in the whole text
+            for (size_t p = seg.end - std::min(seg.end - seg.start, m - 1); p < seg.end; ++p) {
+                c -= !lessWithin(seg, p, bottom) && lessWithin(seg, p, top);
+                c += !less(p, bottom) && less(p, top);
+            }
+        }
+        return c;
+    }
+
+    private:
+    /*!
+        suffix array of the suffixes starting in [start,end) cut at end, with
+        the positions relative to start
+    */
+    struct Segment {
+        size_t start;
+        size_t end;
+        std::vector<int> array;
+    };
+
+    void sortSegment(Segment & seg) {
+        typedef typename key::type key_type;
+        seg.array.assign(seg.end - seg.start, 0);
+        int err = detail::saisCompact(m_data.begin() + seg.start, m_data.begin() + seg.end, seg.array,
+                std::integral_constant<int, sizeof(key_type)>());
+        if (err) {
+            throw std::runtime_error("Could not create suffix array. Error: " + std::to_string(err));
+        }
+    }
+
+    /*!
+        merges the newest segment into the one before it while it is at
+        least half its size
+        The merged segment is sorted again, which takes linear time like
+        merging the two arrays would, as the suffixes of the older segment
+        are extended by the newer one.
+    */
+    void compact() {
+        while (m_segments.size() > 1) {
+            Segment & last = m_segments[m_segments.size() - 2];
+            const Segment & next = m_segments.back();
+            const size_t a = last.end - last.start, b = next.end - next.start;
+            if (2 * b < a || a + b >= size_t(std::numeric_limits<int>::max())) {
+                break;
+            }
+            last.end = next.end;
+            m_segments.pop_back();
+            sortSegment(last);
+        }
+    }
+
+    /*!
+        tells whether the suffix at \a i of the text cut at \a end is smaller
+        than \a p
+    */
+    bool lessUntil(size_t i, size_t end, const string_type & p) const {
+        return detail::cutSuffixLess<key>(m_data.begin(), i, end, p);
+    }
+
+    bool less(size_t i, const string_type & p) const {
+        return lessUntil(i, m_data.size(), p);
+    }
+
+    bool lessWithin(const Segment & seg, size_t i, const string_type & p) const {
+        return lessUntil(i, seg.end, p);
+    }
+
+    /*!
+        returns the number of suffixes of segment \a seg smaller than \a p
+        when cut at the end of the segment
+    */
+    int countLess(const Segment & seg, const string_type & p) const {
+        return detail::countCutSuffixesLess<key>(m_data.begin(), seg.start, seg.end,
+                seg.array.begin(), seg.array.end(), p);
+    }
+
+    /*!
+        the text and its segments in the order of the text
+    */
+    string_type m_data;
+    std::vector<Segment> m_segments;
+};
+}
+
+#endif // INCREMENTAL_SUFFIX_ARRAY_HPP
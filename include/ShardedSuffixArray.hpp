@@ -0,0 +1,242 @@
+#ifndef SHARDED_SUFFIX_ARRAY_HPP
+#define SHARDED_SUFFIX_ARRAY_HPP
+
+#include "SuffixArray.hpp"
+#include "alphabet.hpp"
+#include "batch_match.hpp"
+
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+
+namespace rmatch {
+/*!
+    Suffix array of a text split into shards, each with a suffix array of its
+    own, which are built and searched in parallel.
+
+    Shard k owns the suffixes starting in [s_k,s_{k+1}) and sorts them as if
+    the text ended \a overlap symbols after the end of the shard, so a shard
+    reads only its own part of the text and the overlap. Owning disjoint
+    ranges, the shards never report a suffix twice. The order of a suffix and
+    a pattern of length m is decided by the first m symbols of the suffix, so
+    for patterns of at most overlap+1 symbols every shard is searched
+    exactly. For longer patterns, the suffixes near the end of a shard that
+    are cut before m symbols are compared with the patterns directly.
+
+    Suffix array positions are relative to the start of the shard, so the
+    text may be longer than a single suffix array can index as long as every
+    shard fits.
+
+    Queries fan out to the shards on threads started for each query, which
+    take the shards in turn. The positions found by each shard are sorted by
+    its thread, and as the shards
+    own consecutive ranges of the text, merging their lists into text order
+    is a concatenation.
+*/
+template<typename string_type = std::string>
+class ShardedSuffixArray {
+    public:
+    typedef typename string_type::value_type symbol_type;
+    typedef symbol_key<symbol_type> key;
+
+    /*!
+        builds the suffix arrays of \a shards shards of \a data sorting the
+        suffixes \a overlap symbols past the end of each shard, using at most
+        \a threads threads for building and for queries
+    */
+    ShardedSuffixArray(const string_type & data, size_t shards = detail::naive_threads(),
+            size_t overlap = 256, unsigned threads = detail::naive_threads())
+     : m_data(data), m_overlap(overlap), m_threads(std::max(threads, 1u)) {
+        typedef typename key::type key_type;
+        const size_t n = m_data.size();
+        shards = std::max<size_t>(1, std::min(shards, n));
+        if (n / shards + overlap >= size_t(std::numeric_limits<int>::max())) {
+            throw std::runtime_error("Shards are too large for a suffix array");
+        }
+        m_shards.resize(shards);
+        for (size_t k = 0; k < shards; ++k) {
+            m_shards[k].start = n * k / shards;
+            m_shards[k].end = n * (k + 1) / shards;
+            m_shards[k].cut = std::min(n, m_shards[k].end + overlap);
+        }
+        std::vector<std::string> errors(shards);
+        detail::batch_for(shards, m_threads, 1, [&](unsigned, size_t b, size_t e) {
+            for (size_t k = b; k < e; ++k) {
+                Shard & s = m_shards[k];
+                s.array.resize(s.cut - s.start);
+                int err = detail::saisCompact(m_data.begin() + s.start, m_data.begin() + s.cut, s.array,
+                        std::integral_constant<int, sizeof(key_type)>());
+                if (err) {
+                    errors[k] = std::to_string(err);
+                }
+                // the suffixes of the overlap belong to the next shard
+                const int owned = s.end - s.start;
+                s.array.erase(std::remove_if(s.array.begin(), s.array.end(),
+                        [owned](int p) { return p >= owned; }), s.array.end());
+                s.array.shrink_to_fit();
+            }
+        });
+        for (const std::string & err : errors) {
+            if (!err.empty()) {
+                throw std::runtime_error("Could not create suffix array. Error: " + err);
+            }
+        }
+    }
+
+    /*!
+        length of the text
+    */
+    size_t size() const {
+        return m_data.size();
+    }
+
+    /*!
+        number of shards
+    */
+    size_t shards() const {
+        return m_shards.size();
+    }
+
+    /*!
+        stores the starting positions of the suffixes which are
+        bigger or equal than \a bottom and smaller than \a top in increasing
+        order.
+    */
+    template <typename output_container>
+    void rangeQuery(const string_type & bottom, const string_type & top, output_container& positions) const {
+        std::vector<std::vector<size_t> > parts(m_shards.size());
+        detail::batch_for(m_shards.size(), m_threads, 1, [&](unsigned, size_t b, size_t e) {
+            for (size_t k = b; k < e; ++k) {
+                shardQuery(m_shards[k], bottom, top, parts[k]);
+                std::sort(parts[k].begin(), parts[k].end());
+            }
+        });
+        size_t total = 0;
+        for (const auto & p : parts) {
+            total += p.size();
+        }
+        positions.resize(total);
+        size_t i = 0;
+        for (const auto & p : parts) {
+            std::copy(p.begin(), p.end(), positions.begin() + i);
+            i += p.size();
+        }
+    }
+
+    /*!
+        returns the starting positions of the suffixes which are
+        bigger or equal than \a bottom and smaller than \a top in increasing
+        order.
+    */
+    std::vector<size_t> rangeQuery(const string_type & bottom, const string_type & top) const {
+        std::vector<size_t> positions;
+        rangeQuery(bottom,top,positions);
+        return positions;
+    }
+
+    /*!
+        returns the number of suffixes which are bigger or equal than
+        \a bottom and smaller than \a top
+    */
+    size_t count(const string_type & bottom, const string_type & top) const {
+        std::vector<size_t> counts(m_shards.size());
+        detail::batch_for(m_shards.size(), m_threads, 1, [&](unsigned, size_t b, size_t e) {
+            for (size_t k = b; k < e; ++k) {
+                counts[k] = shardCount(m_shards[k], bottom, top);
+            }
+        });
+        size_t c = 0;
+        for (size_t x : counts) {
+            c += x;
+        }
+        return c;
+    }
+
+    private:
+    /*!
+        suffix array of the suffixes starting in [start,end) cut at cut, with
+        the positions relative to start
+    */
+    struct Shard {
+        size_t start;
+        size_t end;
+        size_t cut;
+        std::vector<int> array;
+    };
+
+    /*!
+        returns the first position of shard \a s whose suffix is cut before
+        the first \a m symbols
+    */
+    size_t tail(const Shard & s, size_t m) const {
+        if (s.cut == m_data.size() || m == 0) {
+            return s.end;
+        }
+        return std::max(s.start, std::min(s.end, s.cut - std::min(s.cut, m - 1)));
+    }
+
+    void shardQuery(const Shard & s, const string_type & bottom, const string_type & top,
+            std::vector<size_t> & positions) const {
+        const size_t t = tail(s, std::max(bottom.size(), top.size()));
+        const int from = countLess(s, bottom);
+        const int to = countLess(s, top);
+        for (int r = from; r < to; ++r) {
+            const size_t p = s.start + s.array[r];
+            if (p < t) {
+                positions.push_back(p);
+            }
+        }
+        for (size_t p = t; p < s.end; ++p) {
+            if (!lessUntil(p, m_data.size(), bottom) && lessUntil(p, m_data.size(), top)) {
+                positions.push_back(p);
+            }
+        }
+    }
+
+    size_t shardCount(const Shard & s, const string_type & bottom, const string_type & top) const {
+        size_t c = std::max(countLess(s, top) - countLess(s, bottom), 0);
+        // the cut suffixes are counted by comparing them with the patterns
+        // as cut and in the whole text
+        for (size_t p = tail(s, std::max(bottom.size(), top.size())); p < s.end; ++p) {
+            c -= !lessUntil(p, s.cut, bottom) && lessUntil(p, s.cut, top);
+            c += !lessUntil(p, m_data.size(), bottom) && lessUntil(p, m_data.size(), top);
+        }
+        return c;
+    }
+
+    /*!
+        tells whether the suffix at \a i of the text cut at \a end is smaller
+        than \a p
+    */
+    bool lessUntil(size_t i, size_t end, const string_type & p) const {
+        return detail::cutSuffixLess<key>(m_data.begin(), i, end, p);
+    }
+
+    /*!
+        returns the number of suffixes of shard \a s smaller than \a p when
+        cut at the cut of the shard
+    */
+    int countLess(const Shard & s, const string_type & p) const {
+        return detail::countCutSuffixesLess<key>(m_data.begin(), s.start, s.cut,
+                s.array.begin(), s.array.end(), p);
+    }
+
+    /*!
+        the text, the number of symbols sorted past the end of each shard
+        and the number of threads
+    */
+    string_type m_data;
+    size_t m_overlap;
+    unsigned m_threads;
+
+    /*!
+        the shards in the order of the text
+    */
+    std::vector<Shard> m_shards;
+};
+}
+
+#endif // SHARDED_SUFFIX_ARRAY_HPP
@@ -2,6 +2,10 @@
 #define SUFFIX_ARRAY_HPP
 
 #include "sais.hxx"
+#include "alphabet.hpp"
+#include "match_length.hpp"
+#include "WaveletMatrix.hpp"
+#include "Util.hpp"
 
 #include <memory>
 #include <vector>
@@ -9,8 +13,187 @@
 #include <stdexcept>
 #include <algorithm>
 #include <iostream>
+#include <iterator>
+#include <type_traits>
+#include <queue>
+#include <tuple>
+#include <random>
+#include <unordered_set>
+#include <cstdint>
 
 namespace rmatch {
+namespace detail {
+/*!
+    Random access adapter presenting the byte symbols of a text to saisxx as
+    non-negative bucket indices ordered the same way as the symbols
+    themselves. Signed characters of negative value would otherwise be used as
+    negative bucket indices.
+*/
+template<typename iterator>
+class sais_key_iterator {
+    public:
+    typedef typename std::iterator_traits<iterator>::value_type symbol_type;
+    typedef symbol_key<symbol_type> key;
+    typedef typename std::make_unsigned<typename key::type>::type value_type;
+    typedef typename std::iterator_traits<iterator>::difference_type difference_type;
+    typedef const value_type* pointer;
+    typedef value_type reference;
+    typedef std::random_access_iterator_tag iterator_category;
+
+    sais_key_iterator(iterator it) : m_it(it) {}
+
+    value_type operator[](difference_type i) const {
+        return static_cast<value_type>(key::get(m_it[i])) ^ flip();
+    }
+    private:
+    /*!
+        flipping the sign bit maps the signed order to the unsigned order
+    */
+    static value_type flip() {
+        return std::is_signed<typename key::type>::value ?
+            value_type(1) << (8*sizeof(value_type)-1) : 0;
+    }
+    iterator m_it;
+};
+
+/*!
+    Constructs the suffix array \a sa of the text [b,e) of byte symbols, which
+    are sorted directly with 256 buckets.
+*/
+template<typename iterator>
+int saisCompact(iterator b, iterator e, std::vector<int> & sa, std::integral_constant<int, 1>) {
+    return saisxx(sais_key_iterator<iterator>(b), sa.begin(), static_cast<int>(e - b));
+}
+
+/*!
+    Constructs the suffix array \a sa of the text [b,e) of 16-bit symbols
+    remapped to the dense codes of the symbols used, which are read through a
+    lookup table.
+*/
+template<typename iterator>
+int saisCompact(iterator b, iterator e, std::vector<int> & sa, std::integral_constant<int, 2>) {
+    alphabet<typename std::iterator_traits<iterator>::value_type> a(b, e);
+    const int k = std::max<int>(a.size(), 1);
+    return saisxx(a.codes(b), sa.begin(), static_cast<int>(e - b), k);
+}
+
+/*!
+    Constructs the suffix array \a sa of the text [b,e) of wide symbols
+    remapped to the dense codes of the symbols used, which are encoded into a
+    temporary array first.
+*/
+template<typename iterator, int width>
+int saisCompact(iterator b, iterator e, std::vector<int> & sa, std::integral_constant<int, width>) {
+    alphabet<typename std::iterator_traits<iterator>::value_type> a(b, e);
+    const int k = std::max<int>(a.size(), 1);
+    std::vector<int> codes;
+    codes.reserve(e - b);
+    a.encode(b, e, std::back_inserter(codes));
+    return saisxx(codes.begin(), sa.begin(), static_cast<int>(e - b), k);
+}
+
+/*!
+    sorts the positions [b,e) smaller than \a n with a least significant
+    digit first radix sort of digitBits bits per pass
+*/
+template<typename iterator>
+void radixSortPositions(iterator b, iterator e, size_t n) {
+    typedef typename std::iterator_traits<iterator>::value_type value_type;
+    const size_t digitBits = 11, buckets = size_t(1) << digitBits;
+    const size_t m = e - b;
+    std::vector<value_type> buffer(m);
+    std::vector<size_t> counts(buckets);
+    bool inBuffer = false;
+    for (size_t shift = 0; shift == 0 || (n - 1) >> shift; shift += digitBits) {
+        std::fill(counts.begin(), counts.end(), 0);
+        for (iterator it = b; it != e; ++it) {
+            ++counts[(*it >> shift) & (buckets - 1)];
+        }
+        size_t sum = 0;
+        for (size_t & c : counts) {
+            const size_t t = c;
+            c = sum;
+            sum += t;
+        }
+        if (inBuffer) {
+            for (const value_type & v : buffer) {
+                b[counts[(v >> shift) & (buckets - 1)]++] = v;
+            }
+        } else {
+            for (iterator it = b; it != e; ++it) {
+                buffer[counts[(*it >> shift) & (buckets - 1)]++] = *it;
+            }
+        }
+        inBuffer = !inBuffer;
+    }
+    if (inBuffer) {
+        std::copy(buffer.begin(), buffer.end(), b);
+    }
+}
+
+/*!
+    writes the positions [b,e) smaller than \a n to \a out in increasing
+    order by marking them in a bit vector of n bits, which is scanned a word
+    at a time
+*/
+template<typename iterator, typename output_iterator>
+void bitsetSortPositions(iterator b, iterator e, size_t n, output_iterator out) {
+    std::vector<uint64_t> bits(n / 64 + 1);
+    for (iterator it = b; it != e; ++it) {
+        bits[*it / 64] |= uint64_t(1) << (*it % 64);
+    }
+    for (size_t w = 0; w < bits.size(); ++w) {
+        for (uint64_t x = bits[w]; x; x &= x - 1) {
+            *out++ = w * 64 + __builtin_ctzll(x);
+        }
+    }
+}
+
+/*!
+    tells whether the suffix at \a i of the text \a text cut at \a cut is
+    smaller than \a p, comparing the symbols by their keys
+*/
+template<typename key, typename text_iterator, typename pattern_type>
+bool cutSuffixLess(text_iterator text, size_t i, size_t cut, const pattern_type & p) {
+    typedef typename pattern_type::value_type symbol_type;
+    return std::lexicographical_compare(
+            text + i, text + std::min(cut, i + p.size()),
+            p.begin(), p.end(),
+            [](const symbol_type & a, const symbol_type & b) {
+                return key::get(a) < key::get(b);
+            });
+}
+
+/*!
+    returns the number of suffixes smaller than \a p in the sorted array
+    [b,e) of suffixes of the text \a text cut at \a cut, whose positions are
+    stored relative to \a base
+*/
+template<typename key, typename text_iterator, typename array_iterator, typename pattern_type>
+size_t countCutSuffixesLess(text_iterator text, size_t base, size_t cut,
+        array_iterator b, array_iterator e, const pattern_type & p) {
+    size_t l = 0, r = e - b;
+    size_t lstr = 0, rstr = 0;
+    while (l < r) {
+        const size_t mid = (l + r) / 2;
+        const size_t i = base + b[mid];
+        // suffixes in (l,r) share the common prefix of the bounds
+        size_t j = std::min(lstr, rstr);
+        j += match_length(text + i + j, p.begin() + j,
+                std::min(cut - i - j, p.size() - j));
+        // the suffix is smaller if it ends first or has a smaller symbol
+        if (j < p.size() && (i + j == cut || key::get(text[i + j]) < key::get(p[j]))) {
+            l = mid + 1;
+            lstr = j;
+        } else {
+            r = mid;
+            rstr = j;
+        }
+    }
+    return l;
+}
+}
+
 /*!
     Suffix array wrapper. It uses the SAIS algorithm, implementation of Yuta Mori in the file sais.hxx
     It generates an lcp array and the inverse suffix array. It also supports range search over the suffixes.
@@ -20,16 +203,28 @@ class SuffixArray {
     public:
     /*!
         Creates a suffix array given the \a data string.
-        Additionally, the inverse suffix array is constructed and the lcp array.
+        Additionally, the inverse suffix array is constructed and the lcp array
+        unless \a aux is false, in which case the auxiliary arrays are left
+        empty and buildInv() and buildLcp() have to be called explicitly
+        before using them.
     */
-    SuffixArray(const string_type & data)
-     : m_data(data), m_array(data.length()), m_array_inv(data.length()), m_lcp(data.length()) {
-        int err = saisxx(m_data.begin(), m_array.begin(), static_cast<int>(m_data.length()));
+    SuffixArray(const string_type & data, bool aux = true)
+     : m_data(data), m_array(data.size()) {
+        typedef typename symbol_key<typename string_type::value_type>::type key_type;
+        /*
+            symbols wider than a byte are compacted to the range [0,k) of the k
+            symbols used, which keeps the bucket arrays of saisxx small
+        */
+        const string_type & data_ref = m_data;
+        int err = detail::saisCompact(data_ref.begin(), data_ref.end(), m_array,
+                std::integral_constant<int, sizeof(key_type)>());
         if (err) {
             throw std::runtime_error("Could not create suffix array. Error: " + err);
         }
-        buildInv();
-        buildLcp();
+        if (aux) {
+            buildInv();
+            buildLcp();
+        }
     }
     public:
     /*!
@@ -52,34 +247,82 @@ class SuffixArray {
     */
     std::vector<int> m_lcp;
 
+    /*!
+        wavelet tree of the suffix array, built by buildWavelet()
+    */
+    WaveletMatrix m_wavelet;
+
+    /*!
+        range minima of the suffix array, built by buildRmq()
+    */
+    RangeMinimum m_rmq;
+
     /*!
         builds the inversed suffix array
     */
     void buildInv() {
-        for (int i = 0; i < m_array.size(); ++i) {
+        m_array_inv.resize(m_array.size());
+        for (int i = 0; i < int(m_array.size()); ++i) {
             m_array_inv[m_array[i]] = i;
         }
     }
 
     /*!
-        constructs the lcp array
+        constructs the lcp array, and the inversed suffix array if it has
+        not been built
     */
     void buildLcp() {
+        using detail::match_length;
+        if (m_array_inv.size() != m_array.size()) {
+            buildInv();
+        }
+        m_lcp.resize(m_array.size());
         int l = 0, k, j;
-        for (int i = 0; i < m_array.size(); ++i) {
+        for (int i = 0; i < int(m_array.size()); ++i) {
             k=m_array_inv[i];
+            // the smallest suffix has no predecessor to compare with
+            if (k == 0) {
+                m_lcp[k] = l = 0;
+                continue;
+            }
             j=m_array[k-1];
-            while (i+l < m_data.length() && j+l < m_data.length() && m_data[i+l]==m_data[j+l]) ++l;
+            l += match_length(m_data.begin()+i+l, m_data.begin()+j+l,
+                    std::max(0, int(m_data.size()) - std::max(i, j) - l));
             m_lcp[k] = l;
             if (l>0) --l;
         }
     }
+    /*!
+        builds the wavelet tree of the suffix array, which the window queries
+        build on their first use otherwise
+    */
+    void buildWavelet() {
+        m_wavelet = WaveletMatrix(m_array.begin(), m_array.end());
+    }
+
+    /*!
+        intervals of the suffix array smaller than this are sorted by
+        comparisons, and the intervals holding at least one in denseFraction
+        suffixes are sorted by marking them in a bit vector of the text
+    */
+    static const size_t sortSmall = 256;
+    static const size_t denseFraction = 64;
+
+    /*!
+        builds the range minima of the suffix array, which the queries of the
+        smallest positions build on their first use otherwise
+    */
+    void buildRmq() {
+        m_rmq = RangeMinimum(m_array);
+    }
+
     /*!
         returns the index in the suffix array for which
         array[0...k] is a subarray for which
         p = array[i], then data[p] < top
     */
     int lowerBound(const string_type & top) {
+        using detail::match_length;
         int lstr = 0, rstr = 0, off = 0;
         int l = 0, r = m_array.size()-1;
         int i,j;
@@ -89,9 +332,12 @@ class SuffixArray {
             i = off+idx;
             j = off;
 
-            while (i<m_data.length() && j < top.length() && m_data[i] == top[j]) ++i, ++j;
+            const int e = match_length(m_data.begin()+i, top.begin()+j,
+                    std::min(m_data.size()-i, top.size()-j));
+            i += e, j += e;
 
-            if (m_data[i]<top[j]) {
+            // the suffix is smaller if it ends first or has a smaller character
+            if (j < int(top.size()) && (i == int(m_data.size()) || m_data[i] < top[j])) {
                 l = mid+1;
                 lstr = j;
             } else {
@@ -109,6 +355,7 @@ class SuffixArray {
         p = array[i], then data[p] >= bottom
     */
     int upperBound(const string_type & bottom) {
+        using detail::match_length;
         int lstr = 0, rstr = 0, off = 0;
         int l = 0, r = m_array.size()-1;
         int i,j;
@@ -118,10 +365,12 @@ class SuffixArray {
             i = off+idx;
             j = off;
 
-            while (i<m_data.length() && j < bottom.length() && m_data[i] == bottom[j]) ++i, ++j;
+            const int e = match_length(m_data.begin()+i, bottom.begin()+j,
+                    std::min(m_data.size()-i, bottom.size()-j));
+            i += e, j += e;
 
             // go right on pattern smaller or equal
-            if (m_data[i] >= bottom[j]) {
+            if (j == int(bottom.size()) || (i < int(m_data.size()) && m_data[i] > bottom[j])) {
                 rstr = j;
                 r = mid-1;
             } else {
@@ -145,6 +394,7 @@ class SuffixArray {
             /*
                 top is bigger than bottom
             */
+            positions.clear();
             return;
         }
         positions.resize(to-from+1);
@@ -164,6 +414,195 @@ class SuffixArray {
         rangeQuery(bottom,top,positions);
         return positions;
     }
+
+    /*!
+        returns the number of suffixes which are bigger or equal than
+        \a bottom and smaller than \a top and start in the window [a,b)
+        of the text.
+        The wavelet tree counts them without visiting the suffixes.
+    */
+    size_t windowCount(const string_type & bottom, const string_type & top, size_t a, size_t b) {
+        int from = upperBound(bottom);
+        int to = lowerBound(top);
+        if (from > to) {
+            return 0;
+        }
+        if (m_wavelet.size() != m_array.size()) {
+            buildWavelet();
+        }
+        return m_wavelet.count(from, to+1, a, b);
+    }
+
+    /*!
+        stores the starting positions of the suffixes which are
+        bigger or equal than \a bottom and smaller than \a top and start in
+        the window [a,b) of the text in increasing order, replacing the
+        contents of \a positions like rangeQuery does.
+    */
+    template <typename output_container>
+    void windowQuery(const string_type & bottom, const string_type & top, size_t a, size_t b, output_container& positions) {
+        positions.clear();
+        int from = upperBound(bottom);
+        int to = lowerBound(top);
+        if (from > to) {
+            return;
+        }
+        if (m_wavelet.size() != m_array.size()) {
+            buildWavelet();
+        }
+        m_wavelet.report(from, to+1, a, b, std::back_inserter(positions));
+    }
+
+    /*!
+        stores the starting positions of the suffixes which are
+        bigger or equal than \a bottom and smaller than \a top in
+        increasing order, like the other algorithms report them.
+        Sparse intervals of the suffix array are sorted by radix sort and
+        dense ones by marking the positions in a bit vector of the text.
+    */
+    template <typename output_container>
+    void sortedRangeQuery(const string_type & bottom, const string_type & top, output_container& positions) {
+        int from = upperBound(bottom);
+        int to = lowerBound(top);
+        if (from > to) {
+            positions.clear();
+            return;
+        }
+        const size_t h = to-from+1, n = m_array.size();
+        positions.resize(h);
+        if (h >= n / denseFraction && h >= sortSmall) {
+            detail::bitsetSortPositions(m_array.begin()+from, m_array.begin()+to+1, n, positions.begin());
+            return;
+        }
+        std::copy(m_array.begin()+from, m_array.begin()+to+1, positions.begin());
+        if (h < sortSmall) {
+            std::sort(positions.begin(), positions.end());
+        } else {
+            detail::radixSortPositions(positions.begin(), positions.end(), n);
+        }
+    }
+
+    /*!
+        returns the starting positions of the suffixes which are
+        bigger or equal than \a bottom and smaller than \a top in
+        increasing order.
+    */
+    std::vector<size_t> sortedRangeQuery(const string_type & bottom, const string_type & top) {
+        std::vector<size_t> positions;
+        sortedRangeQuery(bottom,top,positions);
+        return positions;
+    }
+
+    /*!
+        stores the \a k smallest starting positions of the suffixes which
+        are bigger or equal than \a bottom and smaller than \a top in
+        increasing order.
+        The minimum of the suffix array interval is found with a range
+        minimum query and the interval is split around it, so the time
+        depends on k and not on the size of the interval.
+    */
+    template <typename output_container>
+    void smallestPositions(const string_type & bottom, const string_type & top, size_t k, output_container& positions) {
+        // smallest position of an interval, its index and the interval
+        typedef std::tuple<int, int, int, int> interval;
+        positions.clear();
+        int from = upperBound(bottom);
+        int to = lowerBound(top);
+        if (from > to || k == 0) {
+            return;
+        }
+        if (m_rmq.size() != m_array.size()) {
+            buildRmq();
+        }
+        // intervals of the suffix array by their smallest position
+        std::priority_queue<interval, std::vector<interval>, std::greater<interval> > q;
+        auto push = [&](int a, int b) {
+            if (a <= b) {
+                const int i = m_rmq.minimum(m_array, a, b);
+                q.push(interval(m_array[i], i, a, b));
+            }
+        };
+        push(from, to);
+        for (size_t found = 0; found < k && !q.empty(); ++found) {
+            const interval v = q.top();
+            q.pop();
+            const int i = std::get<1>(v);
+            positions.push_back(std::get<0>(v));
+            push(std::get<2>(v), i-1);
+            push(i+1, std::get<3>(v));
+        }
+    }
+
+    /*!
+        returns the \a k smallest starting positions of the suffixes which
+        are bigger or equal than \a bottom and smaller than \a top in
+        increasing order.
+    */
+    std::vector<size_t> smallestPositions(const string_type & bottom, const string_type & top, size_t k) {
+        std::vector<size_t> positions;
+        smallestPositions(bottom,top,k,positions);
+        return positions;
+    }
+
+    /*!
+        stores a uniform random sample of \a k of the starting positions of
+        the suffixes which are bigger or equal than \a bottom and smaller
+        than \a top in increasing order, or all of them if there are at most
+        k.
+        The sample is drawn without replacement from the suffix array
+        interval with Floyd's algorithm in time proportional to k, and the
+        same \a seed gives the same sample.
+    */
+    template <typename output_container>
+    void samplePositions(const string_type & bottom, const string_type & top, size_t k, uint64_t seed, output_container& positions) {
+        int from = upperBound(bottom);
+        int to = lowerBound(top);
+        if (from > to) {
+            positions.clear();
+            return;
+        }
+        const size_t n = to-from+1;
+        std::vector<size_t> sample;
+        if (k >= n) {
+            sample.assign(m_array.begin()+from, m_array.begin()+to+1);
+        } else {
+            std::mt19937_64 rng(seed);
+            std::unordered_set<size_t> chosen;
+            for (size_t j = n-k; j < n; ++j) {
+                size_t t = uniformBelow(rng, j+1);
+                if (!chosen.insert(t).second) {
+                    t = j;
+                    chosen.insert(t);
+                }
+                sample.push_back(m_array[from+t]);
+            }
+        }
+        std::sort(sample.begin(), sample.end());
+        positions.assign(sample.begin(), sample.end());
+    }
+
+    /*!
+        returns a uniform random sample of \a k of the starting positions of
+        the suffixes which are bigger or equal than \a bottom and smaller
+        than \a top in increasing order, or all of them if there are at most
+        k.
+    */
+    std::vector<size_t> samplePositions(const string_type & bottom, const string_type & top, size_t k, uint64_t seed) {
+        std::vector<size_t> positions;
+        samplePositions(bottom,top,k,seed,positions);
+        return positions;
+    }
+
+    /*!
+        returns the starting positions of the suffixes which are
+        bigger or equal than \a bottom and smaller than \a top and start in
+        the window [a,b) of the text in increasing order.
+    */
+    std::vector<size_t> windowQuery(const string_type & bottom, const string_type & top, size_t a, size_t b) {
+        std::vector<size_t> positions;
+        windowQuery(bottom,top,a,b,positions);
+        return positions;
+    }
 };
     
     template <typename string_type, typename output_container>
@@ -3,9 +3,12 @@
 
 #include <vector>
 #include <iterator>
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <boost/dynamic_bitset.hpp>
 #include <iostream>
+#include <random>
 
 namespace rmatch {
     /*!
@@ -56,7 +59,264 @@ namespace rmatch {
     {
         std::vector<size_t> positions;
         retrieveRangeIndices(lowbits,topbits,positions);
-        return std::move(positions);
+        return positions;
+    }
+
+    /*!
+        type and size of the blocks of a \a boost::dynamic_bitset, which are used
+        as words of bit vectors manipulated a block at a time
+    */
+    typedef boost::dynamic_bitset<>::block_type BitBlock;
+    const size_t blockBits = boost::dynamic_bitset<>::bits_per_block;
+
+    /*!
+        returns \a len <= blockBits bits of \a words starting at bit \a pos
+        in the low bits of a block
+    */
+    inline BitBlock readBits(const std::vector<BitBlock> & words, size_t pos, size_t len)
+    {
+        const size_t w = pos / blockBits, o = pos % blockBits;
+        BitBlock v = words[w] >> o;
+        if (o && o + len > blockBits) v |= words[w+1] << (blockBits - o);
+        return len < blockBits ? v & ((BitBlock(1) << len) - 1) : v;
+    }
+
+    /*!
+        overwrites \a len <= blockBits bits of \a words starting at bit \a pos
+        with the low bits of \a v
+    */
+    inline void writeBits(std::vector<BitBlock> & words, size_t pos, size_t len, BitBlock v)
+    {
+        const size_t w = pos / blockBits, o = pos % blockBits;
+        const BitBlock mask = len < blockBits ? (BitBlock(1) << len) - 1 : ~BitBlock(0);
+        v &= mask;
+        words[w] = (words[w] & ~(mask << o)) | (v << o);
+        if (o && o + len > blockBits)
+        {
+            const size_t r = blockBits - o;
+            words[w+1] = (words[w+1] & ~(mask >> r)) | (v >> r);
+        }
+    }
+
+    /*!
+        copies \a len bits of \a words from position \a src to position \a dst >= src
+        with the same result as copying one bit at a time in increasing order
+        If the ranges overlap, the copied bits therefore repeat with period dst-src.
+        The bits are copied a block at a time; a chunk only reads bits that
+        already have their final value, so with a short period the chunks are
+        read from the copied bits one or more periods back and grow from dst-src
+        bits up to a whole block.
+    */
+    inline void copyBits(std::vector<BitBlock> & words, size_t dst, size_t src, size_t len)
+    {
+        const size_t d = dst - src;
+        if (d == 0) return;
+        size_t done = 0;
+        while (done < len)
+        {
+            /*
+                bits before dst+done are final
+            */
+            size_t from = src + done, avail = d;
+            if (done >= d)
+            {
+                avail = done - done % d;
+                from = dst + done - avail;
+            }
+            const size_t c = std::min(std::min(len - done, avail), blockBits);
+            writeBits(words, dst + done, c, readBits(words, from, c));
+            done += c;
+        }
+    }
+
+    /*!
+        bit vector answering rank queries in constant time
+        The number of ones before every 512 bits is stored in full and the
+        number before every block relative to that, which takes 3/8 bits per
+        bit. The ranks are built by buildRank() after the bits have been set.
+    */
+    class RankBitVector
+    {
+    public:
+        explicit RankBitVector(size_t n = 0) : m_bits(n / blockBits + 1), m_size(n) {}
+
+        void set(size_t i)
+        {
+            m_bits[i / blockBits] |= BitBlock(1) << (i % blockBits);
+        }
+
+        /*!
+            sets bit \a i if \a bit is true without branching on it
+        */
+        void set(size_t i, bool bit)
+        {
+            m_bits[i / blockBits] |= BitBlock(bit) << (i % blockBits);
+        }
+
+        bool operator[](size_t i) const
+        {
+            return (m_bits[i / blockBits] >> (i % blockBits)) & 1;
+        }
+
+        size_t size() const
+        {
+            return m_size;
+        }
+
+        void buildRank()
+        {
+            m_super.assign(m_bits.size() / superBlocks + 1, 0);
+            m_sub.assign(m_bits.size(), 0);
+            size_t c = 0;
+            for (size_t b = 0; b < m_bits.size(); ++b)
+            {
+                if (b % superBlocks == 0)
+                {
+                    m_super[b / superBlocks] = c;
+                }
+                m_sub[b] = c - m_super[b / superBlocks];
+                c += __builtin_popcountll(m_bits[b]);
+            }
+        }
+
+        /*!
+            returns the number of ones before position \a i <= size()
+        */
+        size_t rank(size_t i) const
+        {
+            const size_t b = i / blockBits;
+            const BitBlock below = (BitBlock(1) << (i % blockBits)) - 1;
+            return m_super[b / superBlocks] + m_sub[b] + __builtin_popcountll(m_bits[b] & below);
+        }
+
+        /*!
+            memory used by the bit vector in bytes
+        */
+        size_t bytes() const
+        {
+            return m_bits.capacity() * sizeof(BitBlock)
+                + m_super.capacity() * sizeof(size_t)
+                + m_sub.capacity() * sizeof(uint16_t);
+        }
+
+    private:
+        static const size_t superBlocks = 512 / blockBits;
+
+        std::vector<BitBlock> m_bits;
+        std::vector<size_t> m_super;
+        std::vector<uint16_t> m_sub;
+        size_t m_size;
+    };
+
+    /*!
+        range minimum queries over an array of values, which is passed to the
+        queries instead of being stored
+        The index of the minimum of every block of 64 values is stored, with
+        a sparse table of the minima of 2^j consecutive blocks. A query scans
+        the at most two partial blocks at its ends and looks up two entries of
+        the table for the blocks between them. Ties go to the leftmost index.
+    */
+    class RangeMinimum
+    {
+    public:
+        RangeMinimum() : m_size(0) {}
+
+        template <typename value_vector>
+        explicit RangeMinimum(const value_vector & values) : m_size(values.size())
+        {
+            const size_t blocks = (m_size + block - 1) / block;
+            m_table.assign(1, std::vector<size_t>(blocks));
+            for (size_t b = 0; b < blocks; ++b)
+            {
+                m_table[0][b] = scan(values, b * block, std::min(m_size, (b + 1) * block) - 1);
+            }
+            for (size_t w = 1; 2 * w <= blocks; w *= 2)
+            {
+                const std::vector<size_t> & prev = m_table.back();
+                std::vector<size_t> level(blocks - 2 * w + 1);
+                for (size_t b = 0; b < level.size(); ++b)
+                {
+                    level[b] = smaller(values, prev[b], prev[b + w]);
+                }
+                m_table.push_back(level);
+            }
+        }
+
+        size_t size() const
+        {
+            return m_size;
+        }
+
+        /*!
+            returns the index of the minimum of \a values in [a,b]
+        */
+        template <typename value_vector>
+        size_t minimum(const value_vector & values, size_t a, size_t b) const
+        {
+            const size_t ba = a / block, bb = b / block;
+            if (bb <= ba + 1)
+            {
+                return scan(values, a, b);
+            }
+            size_t k = smaller(values, scan(values, a, (ba + 1) * block - 1), scan(values, bb * block, b));
+            const size_t from = ba + 1;
+            const size_t level = 63 - __builtin_clzll(bb - from);
+            const std::vector<size_t> & t = m_table[level];
+            k = smaller(values, k, t[from]);
+            return smaller(values, k, t[bb - (size_t(1) << level)]);
+        }
+
+        /*!
+            memory used by the structure in bytes
+        */
+        size_t bytes() const
+        {
+            size_t b = 0;
+            for (const auto & t : m_table)
+            {
+                b += t.capacity() * sizeof(size_t);
+            }
+            return b;
+        }
+
+    private:
+        static const size_t block = 64;
+
+        template <typename value_vector>
+        static size_t smaller(const value_vector & values, size_t a, size_t b)
+        {
+            return values[b] < values[a] ? b : a;
+        }
+
+        template <typename value_vector>
+        static size_t scan(const value_vector & values, size_t a, size_t b)
+        {
+            size_t k = a;
+            for (size_t i = a + 1; i <= b; ++i)
+            {
+                k = smaller(values, k, i);
+            }
+            return k;
+        }
+
+        size_t m_size;
+        std::vector<std::vector<size_t> > m_table;
+    };
+
+    /*!
+        returns a uniformly distributed number in [0,bound) drawn from \a rng
+        The numbers of the generator below 2^64 mod bound are rejected, so that
+        the numbers depend only on the seed and not on the standard library,
+        whose distributions may differ between implementations.
+    */
+    inline uint64_t uniformBelow(std::mt19937_64 & rng, uint64_t bound)
+    {
+        const uint64_t threshold = (0 - bound) % bound;
+        for (;;)
+        {
+            const uint64_t x = rng();
+            if (x >= threshold) return x % bound;
+        }
     }
 }
 
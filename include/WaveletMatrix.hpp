@@ -0,0 +1,172 @@
+#ifndef WAVELET_MATRIX_HPP
+#define WAVELET_MATRIX_HPP
+
+#include "Util.hpp"
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+namespace rmatch {
+/*!
+    Wavelet tree of a sequence of integers, stored level by level as a
+    wavelet matrix. Level l holds the l-th highest bit of every value, with
+    the values ordered stably by their higher bits, so that the nodes of the
+    tree at each level are consecutive ranges of a single rank bit vector.
+
+    It counts and reports the values within a range of values in a range of
+    the sequence in O(log u) time per query plus O(log u) per reported value,
+    where u is the largest value.
+*/
+class WaveletMatrix {
+    public:
+    /*!
+        creates an empty sequence
+    */
+    WaveletMatrix() : m_size(0) {}
+
+    /*!
+        builds the wavelet tree of the values of [b,e)
+    */
+    template<typename iterator>
+    WaveletMatrix(iterator b, iterator e) : m_size(e - b) {
+        std::vector<uint64_t> values(b, e);
+        uint64_t max = 0;
+        for (uint64_t v : values) {
+            max = std::max(max, v);
+        }
+        const size_t levels = max ? 64 - __builtin_clzll(max) : 1;
+        m_levels.resize(levels);
+        m_zeros.resize(levels);
+        std::vector<uint64_t> next(m_size);
+        for (size_t l = 0; l < levels; ++l) {
+            const size_t bit = levels - 1 - l;
+            RankBitVector & level = m_levels[l];
+            level = RankBitVector(m_size);
+            size_t z = 0;
+            for (size_t i = 0; i < m_size; ++i) {
+                const bool one = (values[i] >> bit) & 1;
+                level.set(i, one);
+                z += !one;
+            }
+            level.buildRank();
+            m_zeros[l] = z;
+            // zeros go before ones keeping their order; the bits of a
+            // permutation are random, so the indices are chosen without
+            // branching
+            size_t zi = 0, oi = z;
+            for (size_t i = 0; i < m_size; ++i) {
+                const size_t one = (values[i] >> bit) & 1;
+                next[one ? oi : zi] = values[i];
+                oi += one;
+                zi += one ^ 1;
+            }
+            values.swap(next);
+        }
+    }
+
+    /*!
+        length of the sequence
+    */
+    size_t size() const {
+        return m_size;
+    }
+
+    /*!
+        returns the number of values in [lo,hi) at the indices [s,e)
+    */
+    size_t count(size_t s, size_t e, uint64_t lo, uint64_t hi) const {
+        if (s >= e || lo >= hi) {
+            return 0;
+        }
+        return countLess(s, e, hi) - countLess(s, e, lo);
+    }
+
+    /*!
+        writes the values in [lo,hi) at the indices [s,e) to \a out in
+        increasing order
+    */
+    template<typename output_iterator>
+    output_iterator report(size_t s, size_t e, uint64_t lo, uint64_t hi, output_iterator out) const {
+        if (s < e && lo < hi) {
+            report(0, s, e, 0, lo, hi, out);
+        }
+        return out;
+    }
+
+    /*!
+        memory used by the structure in bytes
+    */
+    size_t bytes() const {
+        size_t b = sizeof(*this) + m_zeros.capacity() * sizeof(size_t);
+        for (const RankBitVector & level : m_levels) {
+            b += level.bytes();
+        }
+        return b;
+    }
+
+    private:
+    /*!
+        returns the number of values smaller than \a x at the indices [s,e)
+    */
+    size_t countLess(size_t s, size_t e, uint64_t x) const {
+        const size_t levels = m_levels.size();
+        if (levels < 64 && (x >> levels)) {
+            return e - s;
+        }
+        size_t c = 0;
+        for (size_t l = 0; l < levels && s < e; ++l) {
+            const RankBitVector & level = m_levels[l];
+            const size_t os = level.rank(s), oe = level.rank(e);
+            if ((x >> (levels - 1 - l)) & 1) {
+                // the values with a zero here are smaller
+                c += (e - s) - (oe - os);
+                s = m_zeros[l] + os;
+                e = m_zeros[l] + oe;
+            } else {
+                s -= os;
+                e -= oe;
+            }
+        }
+        return c;
+    }
+
+    /*!
+        reports the values in [lo,hi) of the node at level \a l spanning the
+        indices [s,e) of the level, whose values have the higher bits of
+        \a prefix
+    */
+    template<typename output_iterator>
+    void report(size_t l, size_t s, size_t e, uint64_t prefix,
+            uint64_t lo, uint64_t hi, output_iterator & out) const {
+        const size_t levels = m_levels.size();
+        const size_t bits = levels - l;
+        // the node holds the values [prefix, prefix + 2^bits)
+        const uint64_t first = prefix, last = prefix + ((uint64_t(1) << bits) - 1);
+        if (s >= e || last < lo || first >= hi) {
+            return;
+        }
+        if (l == levels) {
+            for (size_t i = s; i < e; ++i) {
+                *out++ = prefix;
+            }
+            return;
+        }
+        const RankBitVector & level = m_levels[l];
+        const size_t os = level.rank(s), oe = level.rank(e);
+        report(l + 1, s - os, e - oe, prefix, lo, hi, out);
+        report(l + 1, m_zeros[l] + os, m_zeros[l] + oe,
+                prefix | (uint64_t(1) << (bits - 1)), lo, hi, out);
+    }
+
+    size_t m_size;
+
+    /*!
+        bits of each level and the number of zeros in each level
+    */
+    std::vector<RankBitVector> m_levels;
+    std::vector<size_t> m_zeros;
+};
+}
+
+#endif // WAVELET_MATRIX_HPP
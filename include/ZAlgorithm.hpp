@@ -19,16 +19,17 @@ namespace rmatch
 template<typename string_type>
 boost::dynamic_bitset<> lowerBoundZ(const string_type & text, const string_type & pattern)
 {
-    boost::dynamic_bitset<> bits = boost::dynamic_bitset<>(text.length());
+    boost::dynamic_bitset<> bits = boost::dynamic_bitset<>(text.size());
     /*
         combine the text and the pattern like PATTERN$TEXT. We can ommit the $.
     */
-    string_type total = pattern + text;
-    std::vector<size_t> prefixes(pattern.length() + text.length());
+    string_type total(pattern);
+    total.insert(total.end(), text.begin(), text.end());
+    std::vector<size_t> prefixes(pattern.size() + text.size());
     size_t l = 0, r = 0;
-    prefixes[0] = total.length();
+    prefixes[0] = total.size();
     size_t i = 1;
-    while (i<total.length())
+    while (i<total.size())
     {
         if (i > r)
         {
@@ -36,7 +37,7 @@ boost::dynamic_bitset<> lowerBoundZ(const string_type & text, const string_type
                 we just have to extend since we have reached the end of the window
             */
             l = r = i;
-            while (r < total.length() && total[r-l] == total[r]) ++r;
+            while (r < total.size() && total[r-l] == total[r]) ++r;
             prefixes[i] = r-l;
             --r;
         }
@@ -64,29 +65,31 @@ boost::dynamic_bitset<> lowerBoundZ(const string_type & text, const string_type
                     otherwise the prefix mau have a bigger length, so we
                     must extend
                 */
-                while (r < total.length() && total[r-l] == total[r]) ++r;
+                while (r < total.size() && total[r-l] == total[r]) ++r;
                 prefixes[i] = r-l;
                 --r;
             }
         }
-        if (i >= pattern.length())
+        if (i >= pattern.size())
         {
             /*
                 we are checking the text now
             */
             size_t pLen = prefixes[i];
-            size_t textI = i-pattern.length();
-            if (pLen < pattern.length() && pattern[pLen] > text[textI+pLen])
+            size_t textI = i-pattern.size();
+            if (pLen < pattern.size() && (textI+pLen == text.size() || pattern[pLen] > text[textI+pLen]))
             {
                 /*
                     check the character where we have a difference
+                    a suffix ending before the difference is smaller; text[n]
+                    is not available for texts that are not strings
                 */
                 bits[textI] = 1;
             }
         }
         ++i;
     }
-    return std::move(bits);
+    return bits;
 }
 
 /*!
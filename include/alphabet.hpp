@@ -0,0 +1,179 @@
+/*
+ * Alphabet compaction for texts of integer symbols. The symbols occurring in a
+ * text are mapped to a dense range of codes preserving their order, so that
+ * algorithms whose memory use depends on the alphabet size, like suffix array
+ * construction, only pay for the symbols that are actually used.
+ *
+ * Copyright (c) 2015 Jarno Leppänen
+ */
+
+#ifndef ALPHABET_HPP
+#define ALPHABET_HPP
+
+#include <vector>
+#include <unordered_set>
+#include <algorithm>
+#include <iterator>
+#include <type_traits>
+#include <cstdint>
+#include <cstddef>
+
+namespace rmatch {
+
+/**
+ * @brief Integer key of a symbol type.
+ *
+ * Alphabets are built from the keys of the symbols. Symbol types that are not
+ * integers themselves can be used by specializing this template with a key
+ * of the same order as the symbols.
+ */
+template <typename symbol_type>
+struct symbol_key {
+    typedef symbol_type type;
+    static type get(symbol_type c) { return c; }
+};
+
+/**
+ * @brief Order preserving dense codes of the symbols occurring in a text.
+ *
+ * The k symbols of the text are given codes 0,...,k-1 in their own order, so
+ * that comparing codes gives the same result as comparing the symbols. Codes
+ * of symbols of at most 16 bits are looked up from a table indexed by the
+ * symbol; codes of wider symbols are found by binary search.
+ */
+template <typename symbol_type>
+class alphabet {
+public:
+    typedef uint32_t code_type;
+    typedef symbol_key<symbol_type> key;
+    typedef typename key::type key_type;
+    typedef typename std::make_unsigned<key_type>::type unsigned_type;
+
+    /* True, if the codes are looked up from a table. */
+    static const bool dense = sizeof(key_type) <= 2;
+
+    /**
+     * @brief Random access iterator reading the codes of the symbols of a
+     * text with a table lookup.
+     */
+    template <typename iterator>
+    class code_iterator {
+    public:
+        typedef int value_type;
+        typedef typename std::iterator_traits<iterator>::difference_type
+            difference_type;
+        typedef const value_type* pointer;
+        typedef value_type reference;
+        typedef std::random_access_iterator_tag iterator_category;
+
+        code_iterator(const alphabet& a, iterator it): a(&a), it(it) {}
+
+        value_type operator[](difference_type i) const
+        {
+            return a->table[static_cast<unsigned_type>(key::get(it[i]))];
+        }
+
+    private:
+        const alphabet *a;
+        iterator it;
+    };
+
+    /**
+     * Collect the symbols occurring in a text.
+     *
+     * @param b Beginning of the text. (input iterator)
+     * @param e End of the text. (input iterator)
+     */
+    template <typename iterator>
+    alphabet(iterator b, iterator e)
+    {
+        collect(b,e,std::integral_constant<bool,dense>());
+    }
+
+    /**
+     * @return Number of distinct symbols in the text.
+     */
+    size_t size() const { return symbols.size(); }
+
+    /**
+     * @param c Symbol occurring in the text.
+     * @return Code of the symbol.
+     */
+    code_type code(symbol_type c) const
+    {
+        const key_type k = key::get(c);
+        if (dense) return table[static_cast<unsigned_type>(k)];
+        return std::lower_bound(symbols.begin(),symbols.end(),k)
+            - symbols.begin();
+    }
+
+    /**
+     * @param c Code of a symbol.
+     * @return Key of the symbol with the code.
+     */
+    key_type symbol(code_type c) const { return symbols[c]; }
+
+    /**
+     * Create an iterator reading the codes of the symbols of a text without
+     * copying it. Only available for alphabets with dense codes.
+     *
+     * @param it Beginning of the text. (random access iterator)
+     * @return Iterator over the codes.
+     */
+    template <typename iterator>
+    code_iterator<iterator> codes(iterator it) const
+    {
+        return code_iterator<iterator>(*this,it);
+    }
+
+    /**
+     * Write the codes of the symbols of a text.
+     *
+     * @param b Beginning of the text. (input iterator)
+     * @param e End of the text. (input iterator)
+     * @param r Destination of the codes. (output iterator)
+     */
+    template <typename iterator, typename output_iterator>
+    void encode(iterator b, iterator e, output_iterator r) const
+    {
+        for (; b != e; ++b) *r++ = code(*b);
+    }
+
+private:
+    /* Mark the symbols of the text in a table indexed by the symbols. */
+    template <typename iterator>
+    void collect(iterator b, iterator e, std::true_type)
+    {
+        const size_t values = size_t(1) << (8*sizeof(key_type));
+        std::vector<bool> used(values);
+        for (; b != e; ++b) used[static_cast<unsigned_type>(key::get(*b))] = true;
+        // symbols are listed in their own order, which differs from the order
+        // of the unsigned values for signed symbol types
+        const size_t flip = std::is_signed<key_type>::value ? values/2 : 0;
+        for (size_t v = 0; v < values; ++v) {
+            if (used[v ^ flip]) symbols.push_back(key_type(v ^ flip));
+        }
+        table.assign(values,0);
+        for (size_t i = 0; i < symbols.size(); ++i) {
+            table[static_cast<unsigned_type>(symbols[i])] = i;
+        }
+    }
+
+    /* Collect the distinct symbols of the text in a hash set and sort them,
+       so that only the k symbols are held and sorted, not the whole text. */
+    template <typename iterator>
+    void collect(iterator b, iterator e, std::false_type)
+    {
+        std::unordered_set<key_type> distinct;
+        for (; b != e; ++b) distinct.insert(key::get(*b));
+        symbols.assign(distinct.begin(),distinct.end());
+        std::sort(symbols.begin(),symbols.end());
+    }
+
+    std::vector<key_type> symbols;
+    std::vector<code_type> table;
+};
+
+} // rmatch
+
+#endif // ALPHABET_HPP
@@ -0,0 +1,195 @@
+/*
+ * Asynchronous double-buffered file input. A reader thread fills a ring of
+ * chunk buffers ahead of the consumers, so that reading a cold file and
+ * scanning it overlap instead of alternating.
+ *
+ * Copyright (c) 2015 Jarno Leppänen
+ */
+
+#ifndef ASYNC_READER_HPP
+#define ASYNC_READER_HPP
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <limits>
+#include <cstring>
+#include <cstddef>
+#include <cerrno>
+#include <unistd.h>
+
+namespace rmatch {
+
+/**
+ * @brief Reader thread filling a ring of chunk buffers from a file descriptor.
+ *
+ * The file is read with pread() if it is seekable, starting from its current
+ * offset, and with read() otherwise (pipes and terminals). Every chunk is
+ * delivered to a fixed number of consumers, each of which reads the whole file
+ * through its own consumer object. A buffer is refilled only after all
+ * consumers are done with it, so the slowest consumer bounds the memory use to
+ * slots*chunk bytes. The consumer objects can be used as sources of
+ * stream_text, and different consumers can run in different threads.
+ */
+class async_reader {
+public:
+    /**
+     * @brief Source of text characters reading the chunks of one consumer.
+     */
+    class consumer {
+    public:
+        /**
+         * Read the next characters of the file, waiting for the reader thread
+         * if needed.
+         *
+         * @param buf Destination buffer.
+         * @param size Maximum number of characters to read.
+         * @return Number of characters read; 0 at the end of the file or on
+         * error.
+         */
+        size_t read(char *buf, size_t size) { return r->read(*this,buf,size); }
+
+        /**
+         * @return True, if reading the file has failed.
+         */
+        bool failed() const { return r->failed(); }
+
+    private:
+        friend class async_reader;
+        consumer(async_reader *r): r(r), next(0), offset(0) {}
+        async_reader *r;
+        size_t next, offset;
+    };
+
+    /**
+     * Start the reader thread.
+     *
+     * @param fd File descriptor to read. The descriptor is not closed.
+     * @param consumers Number of consumers reading the file.
+     * @param chunk Size of a chunk buffer in bytes.
+     * @param slots Number of chunk buffers in the ring; at least 2.
+     */
+    explicit async_reader(int fd, unsigned consumers = 1,
+            size_t chunk = 1 << 20, size_t slots = 4):
+        fd(fd), chunk(std::max<size_t>(chunk,1)),
+        ring(std::max<size_t>(slots,2)), stop(false), error(false)
+    {
+        for (unsigned i = 0; i < std::max(consumers,1u); ++i) {
+            users.push_back(consumer(this));
+        }
+        for (auto& s: ring) s.data.resize(this->chunk);
+        worker = std::thread([this]() { fill(); });
+    }
+
+    /**
+     * Stop the reader thread. Consumers must not be used afterwards.
+     */
+    ~async_reader()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            stop = true;
+        }
+        freed.notify_all();
+        worker.join();
+    }
+
+    async_reader(const async_reader&) = delete;
+    async_reader& operator=(const async_reader&) = delete;
+
+    /**
+     * @param i Index of the consumer.
+     * @return Consumer i.
+     */
+    consumer& get(unsigned i) { return users[i]; }
+
+    /**
+     * @return True, if reading the file has failed.
+     */
+    bool failed() const
+    {
+        std::lock_guard<std::mutex> lock(m);
+        return error;
+    }
+
+private:
+    /* A chunk buffer. Chunk number seq of the file is in the buffer when
+       readers > 0. An empty chunk marks the end of the file. */
+    struct slot {
+        std::vector<char> data;
+        size_t len, seq;
+        unsigned readers;
+        slot(): len(0), seq(std::numeric_limits<size_t>::max()), readers(0) {}
+    };
+
+    /* Body of the reader thread. */
+    void fill()
+    {
+        off_t pos = lseek(fd,0,SEEK_CUR);
+        const bool seekable = pos != off_t(-1);
+        for (size_t seq = 0; ; ++seq) {
+            slot& s = ring[seq % ring.size()];
+            {
+                std::unique_lock<std::mutex> lock(m);
+                freed.wait(lock,[&]() { return stop || s.readers == 0; });
+                if (stop) return;
+            }
+            // the slot is not touched by the consumers until it is published
+            ssize_t r;
+            do {
+                r = seekable ? pread(fd,&s.data[0],chunk,pos)
+                             : ::read(fd,&s.data[0],chunk);
+            } while (r < 0 && errno == EINTR);
+            {
+                std::lock_guard<std::mutex> lock(m);
+                if (r < 0) error = true;
+                s.len = r < 0 ? 0 : r;
+                s.seq = seq;
+                s.readers = users.size();
+            }
+            filled.notify_all();
+            if (r <= 0) return;
+            pos += r;
+        }
+    }
+
+    /* Copy the next characters of consumer c from the ring. */
+    size_t read(consumer& c, char *buf, size_t size)
+    {
+        slot& s = ring[c.next % ring.size()];
+        {
+            std::unique_lock<std::mutex> lock(m);
+            filled.wait(lock,[&]() { return s.seq == c.next; });
+        }
+        if (s.len == 0) return 0;
+        const size_t r = std::min(size,s.len-c.offset);
+        std::memcpy(buf,&s.data[c.offset],r);
+        c.offset += r;
+        if (c.offset == s.len) {
+            c.offset = 0;
+            ++c.next;
+            bool last;
+            {
+                std::lock_guard<std::mutex> lock(m);
+                last = --s.readers == 0;
+            }
+            if (last) freed.notify_one();
+        }
+        return r;
+    }
+
+    const int fd;
+    const size_t chunk;
+    std::vector<slot> ring;
+    std::vector<consumer> users;
+    mutable std::mutex m;
+    std::condition_variable filled, freed;
+    bool stop, error;
+    std::thread worker;
+};
+
+} // rmatch
+
+#endif // ASYNC_READER_HPP
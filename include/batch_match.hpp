@@ -0,0 +1,275 @@
+/*
+ * String range matching over batches of many short texts. The texts are
+ * stored one after another in a single buffer and processed by a pool of
+ * threads that steal work from each other, with the patterns compiled once for
+ * the whole batch. Results are written into columnar output buffers.
+ *
+ * Copyright (c) 2015 Jarno Leppänen
+ */
+
+#ifndef BATCH_MATCH_HPP
+#define BATCH_MATCH_HPP
+
+#include "gs_count.hpp"
+#include "kmp_match.hpp"
+#include "naive_match.hpp"
+#include "match_length.hpp"
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <algorithm>
+#include <cstddef>
+
+namespace rmatch {
+
+/**
+ * @brief Matches of a batch in columnar form.
+ *
+ * Match j is suffix pos[j] of document doc[j]. Matches are sorted by document
+ * and by position within a document.
+ */
+struct batch_matches {
+    std::vector<size_t> doc;
+    std::vector<size_t> pos;
+};
+
+namespace detail {
+
+/* Default number of documents taken from a work range at a time. */
+const size_t batch_grain = 256;
+
+/* Documents [b,e) still to be processed by a worker. The owner takes documents
+   from the front and other workers steal from the back. */
+struct batch_range {
+    std::mutex m;
+    size_t b, e;
+};
+
+/* Take the next documents [b,e) of worker w, stealing the back half of the
+   documents of another worker if w has run out. Returns false when all
+   documents have been taken. */
+inline bool batch_take(std::vector<batch_range>& rs, size_t w, size_t grain,
+        size_t& b, size_t& e)
+{
+    for (size_t v = 0; v < rs.size(); ++v) {
+        batch_range& r = rs[(w+v) % rs.size()];
+        std::lock_guard<std::mutex> lock(r.m);
+        if (r.b == r.e) continue;
+        if (v == 0) {
+            b = r.b;
+            e = r.b + std::min(grain,r.e-r.b);
+            r.b = e;
+            return true;
+        }
+        // the stolen documents are processed from the front of w's range
+        const size_t s = r.e - (r.e-r.b+1)/2;
+        e = r.e;
+        r.e = s;
+        b = s;
+        break;
+    }
+    if (b == e) return false;
+    batch_range& own = rs[w];
+    std::lock_guard<std::mutex> lock(own.m);
+    own.b = std::min(b+grain,e);
+    own.e = e;
+    e = own.b;
+    return true;
+}
+
+/* Call f(w,b,e) for consecutive ranges of documents [b,e) ⊂ [0,n) on worker
+   threads w ∈ [0,threads). Every worker starts with an equal share of the
+   documents and steals from the others once its own share is done, so that a
+   few long documents do not leave the other threads idle. */
+template <typename function>
+void batch_for(size_t n, unsigned threads, size_t grain, function f)
+{
+    using namespace std;
+    grain = max<size_t>(grain,1);
+    threads = max(1u,min<unsigned>(threads,(n+grain-1)/grain));
+    vector<batch_range> rs(threads);
+    for (unsigned w = 0; w < threads; ++w) {
+        rs[w].b = n*w/threads;
+        rs[w].e = n*(w+1)/threads;
+    }
+    auto work = [&](unsigned w) {
+        size_t b = 0, e = 0;
+        while (batch_take(rs,w,grain,b,e)) {
+            f(w,b,e);
+            b = e = 0;
+        }
+    };
+    vector<thread> workers;
+    for (unsigned w = 1; w < threads; ++w) workers.push_back(thread(work,w));
+    work(0);
+    for (auto& t: workers) t.join();
+}
+
+} // detail
+
+/**
+ * Calculate for each document of a batch the number of suffixes that are
+ * lexicographically larger or equal to compiled pattern l and smaller than
+ * compiled pattern u; i.e. l <= t < u.
+ *
+ * Document d consists of characters buf[offsets[d]..offsets[d+1]). The
+ * documents are counted in parallel by a pool of work stealing threads with
+ * the Galil-Seiferas algorithm, which needs no memory allocation per
+ * document.
+ *
+ * @param buf Buffer holding the documents.
+ * @param offsets Array of docs+1 increasing offsets of the documents in buf.
+ * @param docs Number of documents.
+ * @param l Compiled lower bound pattern.
+ * @param u Compiled upper bound pattern.
+ * @param counts Destination array of docs counts.
+ * @param threads Maximum number of threads to use.
+ */
+inline void batch_count_range(
+        const char *buf, const size_t *offsets, size_t docs,
+        const gs_pattern<size_t>& l,
+        const gs_pattern<size_t>& u,
+        size_t *counts,
+        unsigned threads = detail::naive_threads())
+{
+    detail::batch_for(docs,threads,detail::batch_grain,
+            [&](unsigned, size_t b, size_t e) {
+        for (size_t d = b; d < e; ++d) {
+            counts[d] = gs_count_range(buf+offsets[d],offsets[d+1]-offsets[d],
+                    l,u);
+        }
+    });
+}
+
+/**
+ * Calculate for each document of a batch the number of suffixes that are
+ * lexicographically larger or equal to pattern l and smaller than pattern u;
+ * i.e. l <= t < u.
+ *
+ * @param buf Buffer holding the documents.
+ * @param offsets Offsets of the documents in buf followed by the end offset of
+ * the last document.
+ * @param l Lower bound pattern.
+ * @param u Upper bound pattern.
+ * @param k Constant k used in calculating the k-hrps of the patterns. This
+ * should be larger or equal to 3.
+ * @return Counts of the documents.
+ */
+inline std::vector<size_t> batch_count_range(
+        const std::string& buf,
+        const std::vector<size_t>& offsets,
+        const std::string& l,
+        const std::string& u,
+        size_t k)
+{
+    const size_t docs = offsets.empty() ? 0 : offsets.size()-1;
+    std::vector<size_t> counts(docs);
+    if (docs) {
+        batch_count_range(buf.data(),offsets.data(),docs,
+                gs_pattern<size_t>(l,k),gs_pattern<size_t>(u,k),counts.data());
+    }
+    return counts;
+}
+
+/**
+ * Calculate the suffixes of the documents of a batch that are
+ * lexicographically larger or equal to compiled pattern l and smaller than
+ * compiled pattern u; i.e. l <= t < u.
+ *
+ * Document d consists of characters buf[offsets[d]..offsets[d+1]). The
+ * documents are matched in parallel by a pool of work stealing threads, each
+ * of which compares both patterns during a single pass over a document. The
+ * matches of every range of documents are buffered by its thread and copied
+ * to the output in document order at the end.
+ *
+ * @param buf Buffer holding the documents.
+ * @param offsets Array of docs+1 increasing offsets of the documents in buf.
+ * @param docs Number of documents.
+ * @param l Compiled lower bound pattern.
+ * @param u Compiled upper bound pattern.
+ * @param r Destination of the matches, which are appended to it.
+ * @param threads Maximum number of threads to use.
+ */
+inline void batch_match_range(
+        const char *buf, const size_t *offsets, size_t docs,
+        const kmp_pattern<size_t>& l,
+        const kmp_pattern<size_t>& u,
+        batch_matches& r,
+        unsigned threads = detail::naive_threads())
+{
+    using namespace std;
+    typedef kmp_pattern<size_t>::index_type index_type;
+    typedef detail::array_text<const char*,index_type> text;
+    typedef detail::kmp_matcher<text,kmp_pattern<size_t>::iterator,index_type>
+        matcher;
+    // matches of documents [b,e) are in [from,to) of the buffers of a worker
+    struct part { size_t b, w, from, to; };
+    const size_t workers = max(1u,threads);
+    vector<batch_matches> found(workers);
+    vector<vector<part>> parts(workers);
+    detail::batch_for(docs,threads,detail::batch_grain,
+            [&](unsigned w, size_t b, size_t e) {
+        batch_matches& f = found[w];
+        const size_t from = f.pos.size();
+        for (size_t d = b; d < e; ++d) {
+            const index_type n = offsets[d+1]-offsets[d];
+            text t(buf+offsets[d],n);
+            matcher lm(t,l.begin(),l.size(),l.lcps());
+            matcher um(t,u.begin(),u.size(),u.lcps());
+            for (index_type i = 0; i < n; ++i) {
+                // both matchers must see every suffix
+                const bool less_u = um.less(i);
+                const bool less_l = lm.less(i);
+                if (less_u && !less_l) {
+                    f.doc.push_back(d);
+                    f.pos.push_back(i);
+                }
+            }
+        }
+        parts[w].push_back(part{b,w,from,f.pos.size()});
+    });
+    vector<part> all;
+    for (auto& p: parts) all.insert(all.end(),p.begin(),p.end());
+    sort(all.begin(),all.end(),
+            [](const part& a, const part& b) { return a.b < b.b; });
+    size_t total = r.pos.size();
+    for (const part& p: all) total += p.to-p.from;
+    r.doc.reserve(total);
+    r.pos.reserve(total);
+    for (const part& p: all) {
+        const batch_matches& f = found[p.w];
+        r.doc.insert(r.doc.end(),f.doc.begin()+p.from,f.doc.begin()+p.to);
+        r.pos.insert(r.pos.end(),f.pos.begin()+p.from,f.pos.begin()+p.to);
+    }
+}
+
+/**
+ * Calculate the suffixes of the documents of a batch that are
+ * lexicographically larger or equal to pattern l and smaller than pattern u;
+ * i.e. l <= t < u.
+ *
+ * @param buf Buffer holding the documents.
+ * @param offsets Offsets of the documents in buf followed by the end offset of
+ * the last document.
+ * @param l Lower bound pattern.
+ * @param u Upper bound pattern.
+ * @return Matches of the documents.
+ */
+inline batch_matches batch_match_range(
+        const std::string& buf,
+        const std::vector<size_t>& offsets,
+        const std::string& l,
+        const std::string& u)
+{
+    batch_matches r;
+    if (offsets.size() > 1) {
+        batch_match_range(buf.data(),offsets.data(),offsets.size()-1,
+                kmp_pattern<size_t>(l),kmp_pattern<size_t>(u),r);
+    }
+    return r;
+}
+
+} // rmatch
+
+#endif // BATCH_MATCH_HPP
@@ -0,0 +1,236 @@
+/*
+ * Burrows-Wheeler transform by blockwise suffix sorting in small space, as
+ * described in:
+ *
+ * J. Kärkkäinen: Fast BWT in small space by blockwise suffix sorting.
+ * Theoretical Computer Science 387, pp. 249–257, 2007.
+ * http://dx.doi.org/10.1016/j.tcs.2007.07.018
+ *
+ * The suffixes are divided into lexicographic blocks by splitter strings. The
+ * sizes of the blocks are counted with the Galil-Seiferas count, the suffixes
+ * of each block are gathered with the Knuth-Morris-Pratt range matching and
+ * sorted with a string sort, and the BWT is written out block by block, so
+ * that only one block of suffixes is held in memory besides the text.
+ *
+ * Copyright (c) 2015 Jarno Leppänen
+ */
+
+#ifndef BWT_HPP
+#define BWT_HPP
+
+#include "gs_count.hpp"
+#include "kmp_match.hpp"
+#include "match_length.hpp"
+#include "suffix_splitters.hpp"
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <cstddef>
+
+namespace rmatch {
+namespace detail {
+
+/* Groups of suffixes sharing a prefix of this many characters are sorted by
+   comparing whole suffixes, which extends the long common prefixes of
+   repetitive texts with SIMD instead of one character per partitioning
+   step. */
+const size_t bwt_string_sort_depth = 64;
+
+/* Groups smaller than this are sorted by comparing whole suffixes. */
+const size_t bwt_string_sort_small = 16;
+
+/* Character t[p+d] of suffix t[p..n) as a key ordered like char, or 0 past the
+   end of the text. */
+inline int bwt_key(const char *t, size_t n, size_t p, size_t d)
+{
+    return p+d < n ? int(t[p+d]) - std::numeric_limits<char>::min() + 1 : 0;
+}
+
+/* Sort the suffixes at positions a[0..m), which share their first d
+   characters, with multikey quicksort. */
+inline void bwt_string_sort(const char *t, size_t n, size_t *a, size_t m,
+        size_t d)
+{
+    using namespace std;
+    while (m > 1) {
+        if (m < bwt_string_sort_small || d >= bwt_string_sort_depth) {
+            sort(a,a+m,[=](size_t x, size_t y) {
+                return suffix_less(t,n,x,y,d);
+            });
+            return;
+        }
+        int k[3] = { bwt_key(t,n,a[0],d), bwt_key(t,n,a[m/2],d),
+            bwt_key(t,n,a[m-1],d) };
+        sort(k,k+3);
+        const int v = k[1];
+        // a[0..lt) < v, a[lt..gt) == v, a[gt..m) > v
+        size_t lt = 0, i = 0, gt = m;
+        while (i < gt) {
+            const int c = bwt_key(t,n,a[i],d);
+            if (c < v) swap(a[lt++],a[i++]);
+            else if (c > v) swap(a[i],a[--gt]);
+            else ++i;
+        }
+        bwt_string_sort(t,n,a,lt,d);
+        bwt_string_sort(t,n,a+gt,m-gt,d);
+        // at most one suffix ends at depth d
+        if (v == 0) return;
+        a += lt;
+        m = gt-lt;
+        ++d;
+    }
+}
+
+/* Call f(i) in increasing order for the suffixes t[i..n) with l <= t[i..n) <
+   u. A null bound is left open. */
+template <typename function>
+void bwt_block(const char *t, size_t n,
+        const std::string *l, const std::string *u, function f)
+{
+    typedef kmp_match_less_iterator<const char*,size_t> less;
+    if (!l && !u) {
+        for (size_t i = 0; i < n; ++i) f(i);
+    } else if (!l) {
+        for (less it(t,n,u->data(),u->size()); it != it.end(); ++it) f(*it);
+    } else if (!u) {
+        // the complement of the suffixes smaller than l
+        size_t i = 0;
+        for (less it(t,n,l->data(),l->size()); it != it.end(); ++it) {
+            for (; i < *it; ++i) f(i);
+            ++i;
+        }
+        for (; i < n; ++i) f(i);
+    } else {
+        struct output: std::iterator<std::output_iterator_tag,void,void,void,void> {
+            function& f;
+            output(function& f): f(f) {}
+            output& operator=(size_t i) { f(i); return *this; }
+            output& operator*() { return *this; }
+            output& operator++() { return *this; }
+            output& operator++(int) { return *this; }
+        };
+        kmp_match_range(t,n,l->data(),l->size(),u->data(),u->size(),
+                output(f));
+    }
+}
+
+/* Splitter presented to the Galil-Seiferas count as a character array like
+   the text. */
+struct bwt_pattern {
+    const char *p;
+    size_t m;
+    const char *begin() const { return p; }
+    size_t size() const { return m; }
+};
+
+/* Choose splitters dividing the suffixes t[i..n) with l <= t[i..n) < u, of
+   which there are c, into blocks of about capacity/2 suffixes. */
+inline std::vector<std::string> bwt_splitters(const char *t, size_t n,
+        const std::string *l, const std::string *u, size_t c,
+        size_t capacity, size_t prefix)
+{
+    std::vector<std::string> s = sample_splitters(t,n,
+            [&](const position_sink& f) { bwt_block(t,n,l,u,f); },
+            c,2*c/capacity+1,capacity*sizeof(size_t),prefix);
+    // splitters must lie strictly inside the range
+    s.erase(std::remove_if(s.begin(),s.end(),[&](const std::string& p) {
+        return (l && !string_less(*l,p)) || (u && !string_less(p,*u));
+    }),s.end());
+    return s;
+}
+
+} // detail
+
+/**
+ * Calculate the Burrows-Wheeler transform of text t followed by an end marker
+ * smaller than all characters, in O(n + capacity) space besides the output.
+ *
+ * The suffixes are sorted in lexicographic blocks of at most
+ * memory/sizeof(size_t) suffixes. Splitters between the blocks are sampled
+ * from the text, the block sizes are counted with a single interleaved
+ * Galil-Seiferas count of all the splitters, and blocks that turn out too
+ * large are split again with longer splitters. Each block is then gathered
+ * with Knuth-Morris-Pratt range matching in O(n) time, sorted with multikey
+ * quicksort and written out.
+ *
+ * @param t Input text.
+ * @param n Size of the input text.
+ * @param memory Number of bytes available for a block of suffixes.
+ * @param r Destination of the n characters of the transform without the end
+ * marker. (output iterator)
+ * @return Index of the end marker in the transform, which is the rank of the
+ * whole text among the suffixes counting the empty suffix.
+ */
+template <typename output_iterator>
+size_t bwt_blockwise(const char *t, size_t n, size_t memory,
+        output_iterator r)
+{
+    using namespace std;
+    using namespace rmatch::detail;
+    if (n == 0) return 0;
+    const size_t capacity = max<size_t>(memory/sizeof(size_t),1);
+
+    // splitters and the number of suffixes in each block; block j holds the
+    // suffixes from s[j-1] to s[j] with open ends
+    vector<string> s;
+    vector<size_t> counts(1,n);
+    size_t prefix = 32;
+    for (;;) {
+        vector<string> added;
+        bool large = false;
+        for (size_t j = 0; j < counts.size(); ++j) {
+            if (counts[j] <= capacity) continue;
+            large = true;
+            const string *l = j ? &s[j-1] : nullptr;
+            const string *u = j < s.size() ? &s[j] : nullptr;
+            vector<string> b = bwt_splitters(t,n,l,u,counts[j],capacity,
+                    prefix);
+            added.insert(added.end(),b.begin(),b.end());
+        }
+        if (!large) break;
+        // blocks whose sampled prefixes are all equal are split with longer
+        // prefixes on the next round
+        prefix *= 2;
+        if (added.empty()) continue;
+        s.insert(s.end(),added.begin(),added.end());
+        sort(s.begin(),s.end(),string_less);
+        vector<bwt_pattern> ps;
+        for (const string& p: s) ps.push_back(bwt_pattern{p.data(),p.size()});
+        vector<size_t> less;
+        gs_count_less_multi(t,n,ps.begin(),ps.end(),size_t(3),
+                back_inserter(less));
+        counts.assign(s.size()+1,0);
+        size_t before = 0;
+        for (size_t j = 0; j < s.size(); ++j) {
+            counts[j] = less[j]-before;
+            before = less[j];
+        }
+        counts.back() = n-before;
+    }
+
+    // the empty suffix comes first
+    *r++ = t[n-1];
+    size_t row = 1, primary = 0;
+    vector<size_t> block;
+    for (size_t j = 0; j < counts.size(); ++j) {
+        const string *l = j ? &s[j-1] : nullptr;
+        const string *u = j < s.size() ? &s[j] : nullptr;
+        block.clear();
+        block.reserve(counts[j]);
+        bwt_block(t,n,l,u,[&](size_t i) { block.push_back(i); });
+        bwt_string_sort(t,n,block.data(),block.size(),0);
+        for (size_t p: block) {
+            if (p) *r++ = t[p-1];
+            else primary = row;
+            ++row;
+        }
+    }
+    return primary;
+}
+
+} // rmatch
+
+#endif // BWT_HPP
@@ -15,6 +15,13 @@
 #define GS_COUNT_HPP
 
 #include "gs_count_detail.hpp"
+#include "match_length.hpp"
+#include "stream_text.hpp"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <iterator>
 
 namespace rmatch {
 namespace detail {
@@ -29,7 +36,7 @@ s_t<index_type> gs_precompute(string_type y, index_type m, index_type k)
     add(s.n,index_type(1),index_type(0));
     index_type i = 1, last = 1, l = 0, count = 0;
     while (i < m) { // Invariant: count = |y_[0..i) ∩ [ɛ,y)|
-        while (i+l < m && y[i+l] == y[l]) ++l;
+        l += match_length(y+(i+l),y+l,m-(i+l));
         index_type b, e, c;
         contains(s.p,l,b,e,c);
         if (k*i <= i+l && b == 0) {
@@ -55,6 +62,127 @@ s_t<index_type> gs_precompute(string_type y, index_type m, index_type k)
     return s;
 }
 
+/* The counting loop of gs_count_less() over the precomputed scopes s of
+   pattern y, run over the suffixes of text x starting before position end,
+   which may be passed by less than the pattern length. The count and the
+   state (i,l) of the loop are carried from one run to the next. The text is
+   a stream_text or an array_text, which is only accessed at positions
+   [i,i+m]. */
+template <typename text, typename pattern_type, typename index_type>
+void gs_count_loop(
+        text& x,
+        pattern_type y, index_type m,
+        index_type k, const s_t<index_type>& s,
+        index_type end, index_type& count, index_type& i, index_type& l)
+{
+    // the loop runs on local copies of the state
+    index_type cnt = count, ii = i, ll = l;
+    while (ii < end) { // Invariant: cnt = |x_[0..ii) ∩ [ɛ,y)|
+        ll += x.match_length(ii+ll,y+ll,m-ll);
+        index_type b, e, c;
+        contains(s.p,ll,b,e,c);
+        if (ll < m && (!x.has(ii+ll) || x[ii+ll] < y[ll])) ++cnt;
+        if (b != 0) { // per(y[0..ll)) = b/2
+            // c = |Y_[1..b/2) ∩ [ɛ,y)| = |x_[ii+1..ii+b/2) ∩ [ɛ,y)|
+            cnt += c;
+            ii += b/2;
+            ll -= b/2;
+        } else { // per(y[0..ll)) > ll/k
+            pred(s.n,ll/k+1,b,c); // (⌊ll/k⌋+1)/4 < b
+            // c = |Y_[1..b) ∩ [ɛ,y)| = |x_[ii+1..ii+b) ∩ [ɛ,y)|
+            cnt += c;
+            ii += b;
+            ll = 0;
+        }
+    }
+    count = cnt;
+    i = ii;
+    l = ll;
+}
+
+/* Galil-Seiferas count of the suffixes of a text smaller than a pattern that
+   can be advanced over the text in steps, so that counts of several patterns
+   can take turns over the same block of the text. */
+template <typename string_type, typename index_type>
+class gs_counter {
+public:
+    gs_counter(string_type x, index_type n,
+            string_type y, index_type m, index_type k):
+        x(x,n), y(y), m(m), s(gs_precompute(y,m,k)), k(k), c(0), i(0), l(0)
+    {}
+
+    /* Count the suffixes starting before position end. The count may advance
+       past end by less than the pattern length. */
+    void advance(index_type end)
+    {
+        gs_count_loop(x,y,m,k,s,std::min(end,x.n),c,i,l);
+    }
+
+    /* Number of smaller suffixes found so far. */
+    index_type count() const { return c; }
+
+private:
+    array_text<string_type,index_type> x;
+    string_type y;
+    index_type m;
+    s_t<index_type> s;
+    index_type k;
+    index_type c, i, l;
+};
+
+/* Galil-Seiferas count over a streamed text. The outer loop of
+   gs_count_less() is run one iteration at a time by step(), so that counts of
+   several patterns can advance together over a single pass of the text. The
+   text is only accessed at positions [i,i+m]. */
+template <typename source_type, typename string_type, typename index_type>
+class gs_stream_counter {
+public:
+    gs_stream_counter(stream_text<source_type>& x,
+            string_type y, index_type m, index_type k):
+        x(x), y(y), m(m), s(gs_precompute(y,m,k)), k(k), c(0), i(0), l(0)
+    {
+        x.require_lookback(m+1);
+    }
+
+    /* Run one iteration of the outer loop. Returns false at the end of the
+       text. */
+    bool step()
+    {
+        if (!x.has(i)) return false;
+        gs_count_loop(x,y,m,k,s,i+1,c,i,l);
+        return true;
+    }
+
+    /* Position of the next suffix to be compared. */
+    index_type position() const { return i; }
+
+    /* Number of smaller suffixes found so far. */
+    index_type count() const { return c; }
+
+private:
+    stream_text<source_type>& x;
+    const string_type y;
+    const index_type m;
+    const s_t<index_type> s;
+    const index_type k;
+    index_type c, i, l;
+};
+
+/* The counting loop of gs_count_less() over the whole text with the
+   precomputed scopes s of the pattern. The text and the pattern may be of
+   different iterator types. */
+template <typename text_type, typename pattern_type, typename index_type>
+index_type gs_count_scan(
+        text_type x, index_type n,
+        pattern_type y, index_type m,
+        index_type k, const s_t<index_type>& s)
+{
+    array_text<text_type,index_type> t(x,n);
+    index_type count = 0, i = 0, l = 0;
+    gs_count_loop(t,y,m,k,s,n,count,i,l);
+    return count;
+}
+
 } // detail
 
 /**
@@ -75,29 +203,7 @@ index_type gs_count_less(
         string_type y, index_type m,
         index_type k)
 {
-    using namespace std;
-    using namespace rmatch::detail;
-    s_t<index_type> s = gs_precompute(y,m,k);
-    index_type count = 0, i = 0, l = 0;
-    while (i < n) { // Invariant: count = |x_[0..i) ∩ [ɛ,y)|
-        while (i+l < n && l < m && x[i+l] == y[l]) ++l;
-        index_type b, e, c;
-        contains(s.p,l,b,e,c);
-        if (l < m && (i+l == n || x[i+l] < y[l])) ++count;
-        if (b != 0) { // per(y[0..l)) = b/2
-            // c = |Y_[1..b/2) ∩ [ɛ,y)| = |x_[i+1..i+b/2) ∩ [ɛ,y)|
-            count += c;
-            i += b/2;
-            l -= b/2;
-        } else { // per(y[0..l)) > l/k
-            pred(s.n,l/k+1,b,c); // (⌊l/k⌋+1)/4 < b
-            // c = |Y_[1..b) ∩ [ɛ,y)| = |x_[i+1..i+b) ∩ [ɛ,y)|
-            count += c;
-            i += b;
-            l = 0;
-        }
-    }
-    return count;
+    return detail::gs_count_scan(x,n,y,m,k,detail::gs_precompute(y,m,k));
 }
 
 /**
@@ -151,6 +257,267 @@ typename string_type::size_type gs_count_range(
             k);
 }
 
+/**
+ * @brief Pattern compiled for Galil-Seiferas counting.
+ *
+ * Holds a copy of the pattern together with its precomputed O(log(m)) scopes,
+ * so that the same pattern can be counted over many texts without repeating
+ * the precomputation. The object is immutable and can be shared between
+ * threads.
+ */
+template <typename index_type = size_t>
+class gs_pattern {
+public:
+    typedef std::string::const_iterator iterator;
+
+    /**
+     * @param y Pattern.
+     * @param k Constant k used in calculating the k-hrps of the pattern. This
+     * should be larger or equal to 3.
+     */
+    gs_pattern(const std::string& y, index_type k):
+        y(y), k(k), s(detail::gs_precompute(begin(),size(),k)) {}
+
+    /**
+     * @return Beginning of the pattern.
+     */
+    iterator begin() const { return y.begin(); }
+
+    /**
+     * @return Length of the pattern.
+     */
+    index_type size() const { return y.size(); }
+
+    /**
+     * @return Constant k the pattern was compiled with.
+     */
+    index_type khrp() const { return k; }
+
+    /**
+     * @return Precomputed scopes of the pattern.
+     */
+    const detail::s_t<index_type>& scopes() const { return s; }
+
+private:
+    const std::string y;
+    const index_type k;
+    const detail::s_t<index_type> s;
+};
+
+/**
+ * Calculate the number of suffixes in a text that are lexicographically smaller
+ * than a compiled pattern in linear time.
+ *
+ * @param x Input text. (random access iterator)
+ * @param n Length of the input text.
+ * @param y Compiled pattern.
+ * @return Number of matching suffixes in the text.
+ */
+template <typename string_type, typename index_type>
+index_type gs_count_less(
+        string_type x, index_type n,
+        const gs_pattern<index_type>& y)
+{
+    return detail::gs_count_scan(x,n,y.begin(),y.size(),y.khrp(),y.scopes());
+}
+
+/**
+ * Calculate the number of suffixes in a text x that are lexicographically
+ * larger or equal to compiled pattern b and smaller than compiled pattern e;
+ * i.e. b <= x < e.
+ *
+ * @param x Input text. (random access iterator)
+ * @param n Size of the input text.
+ * @param b Compiled lower bound pattern.
+ * @param e Compiled upper bound pattern.
+ * @return Number of matching suffixes in the text.
+ */
+template <typename string_type, typename index_type>
+index_type gs_count_range(
+        string_type x, index_type n,
+        const gs_pattern<index_type>& b,
+        const gs_pattern<index_type>& e)
+{
+    index_type l = gs_count_less(x,n,b);
+    index_type u = gs_count_less(x,n,e);
+    return u < l ? 0 : u - l;
+}
+
+/**
+ * Calculate the number of suffixes in a text x that are lexicographically
+ * larger or equal to compiled pattern b and smaller than compiled pattern e;
+ * i.e. b <= x < e.
+ *
+ * @param x Input text. (random access container)
+ * @param b Compiled lower bound pattern.
+ * @param e Compiled upper bound pattern.
+ * @return Number of matching suffixes in the text.
+ */
+template <typename string_type>
+typename string_type::size_type gs_count_range(
+        const string_type& x,
+        const gs_pattern<typename string_type::size_type>& b,
+        const gs_pattern<typename string_type::size_type>& e)
+{
+    return gs_count_range(x.begin(),x.size(),b,e);
+}
+
+/* Default number of text characters scanned by each pattern in turn by
+   gs_count_less_multi(). Blocks of this size stay in the L2 cache. */
+const size_t gs_multi_block = 1 << 16;
+
+/**
+ * Calculate the number of suffixes in a text that are lexicographically smaller
+ * than each of the given patterns. The text is divided into blocks that every
+ * pattern is counted over in turn, so that the block is read from memory once
+ * and stays in cache for the rest of the patterns. Each pattern keeps its own
+ * O(log(m)) precomputed scopes.
+ *
+ * @param x Input text. (random access iterator)
+ * @param n Length of the input text.
+ * @param p Beginning of the patterns. (forward iterator over random access
+ * containers whose const iterator type is string_type)
+ * @param pe End of the patterns. (forward iterator)
+ * @param k Constant k used in calculating the k-hrps of the patterns. This
+ * should be larger or equal to 3.
+ * @param r Destination of the counts in the order of the patterns. (output
+ * iterator)
+ * @param block Number of text characters each pattern is counted over in turn.
+ */
+template <typename string_type, typename index_type,
+         typename pattern_iterator, typename output_iterator>
+void gs_count_less_multi(
+        string_type x, index_type n,
+        pattern_iterator p, pattern_iterator pe,
+        index_type k,
+        output_iterator r,
+        index_type block = gs_multi_block)
+{
+    typedef detail::gs_counter<string_type,index_type> counter;
+    std::vector<counter> cs;
+    for (; p != pe; ++p) cs.push_back(counter(x,n,p->begin(),p->size(),k));
+    block = std::max<index_type>(block,1);
+    for (index_type e = 0; e < n; ) {
+        e = n-e > block ? e+block : n;
+        for (auto& c: cs) c.advance(e);
+    }
+    for (auto& c: cs) *r++ = c.count();
+}
+
+/**
+ * Calculate the number of suffixes in a text that are lexicographically smaller
+ * than each of the given patterns in a single interleaved pass over the text.
+ *
+ * @param x Input text. (random access container)
+ * @param ps Patterns. (container of random access containers)
+ * @param k Constant k used in calculating the k-hrps of the patterns. This
+ * should be larger or equal to 3.
+ * @param r Destination of the counts in the order of the patterns. (output
+ * iterator)
+ */
+template <typename string_type, typename pattern_container,
+         typename output_iterator>
+void gs_count_less_multi(
+        const string_type& x,
+        const pattern_container& ps,
+        typename string_type::size_type k,
+        output_iterator r)
+{
+    gs_count_less_multi(x.begin(),x.size(),ps.begin(),ps.end(),k,r);
+}
+
+/**
+ * Calculate a histogram of the suffixes of a text over lexicographic buckets:
+ * the number of suffixes larger or equal to bound b[j] and smaller than bound
+ * b[j+1] for each pair of consecutive bounds. All bounds are counted in a
+ * single interleaved pass over the text.
+ *
+ * @param x Input text. (random access container)
+ * @param bs Lexicographically sorted bounds of the buckets. (container of
+ * random access containers)
+ * @param k Constant k used in calculating the k-hrps of the patterns. This
+ * should be larger or equal to 3.
+ * @param r Destination of the bs.size()-1 bucket counts. (output iterator)
+ */
+template <typename string_type, typename pattern_container,
+         typename output_iterator>
+void gs_count_buckets(
+        const string_type& x,
+        const pattern_container& bs,
+        typename string_type::size_type k,
+        output_iterator r)
+{
+    typedef typename string_type::size_type size_type;
+    std::vector<size_type> less;
+    gs_count_less_multi(x,bs,k,std::back_inserter(less));
+    for (size_t j = 1; j < less.size(); ++j) {
+        *r++ = less[j] < less[j-1] ? 0 : less[j]-less[j-1];
+    }
+}
+
+/**
+ * Calculate the number of suffixes in a streamed text that are
+ * lexicographically smaller than a given pattern in linear time. Only
+ * O(log(m)) extra space and a window of m+1 characters of the text are kept in
+ * memory.
+ *
+ * @param x Input text, which is read to its end.
+ * @param y Input pattern. (random access iterator)
+ * @param m Length of the input pattern.
+ * @param k Constant k used in calculating the k-hrps of the pattern. This
+ * should be larger or equal to 3.
+ * @return Number of matching suffixes in the text.
+ */
+template <typename source_type, typename string_type, typename index_type>
+index_type gs_count_less(
+        stream_text<source_type>& x,
+        string_type y, index_type m,
+        index_type k)
+{
+    detail::gs_stream_counter<source_type,string_type,index_type> c(x,y,m,k);
+    while (c.step());
+    return c.count();
+}
+
+/**
+ * Calculate the number of suffixes in a streamed text x that are
+ * lexicographically larger or equal to pattern b and smaller than pattern e;
+ * i.e. b <= x < e. Both patterns are counted during a single pass over the
+ * text by always advancing the count that is behind, which keeps the window of
+ * the text in memory shorter than 2*max(m1,m2)+2 characters.
+ *
+ * @param x Input text, which is read to its end.
+ * @param b Lower bound pattern. (random access iterator)
+ * @param m1 Size of the lower bound pattern.
+ * @param e Upper bound pattern. (random access iterator)
+ * @param m2 Size of the upper bound pattern.
+ * @param k Constant k used in calculating the k-hrps of the patterns. This
+ * should be larger or equal to 3.
+ * @return Number of matching suffixes in the text.
+ */
+template <typename source_type, typename string_type, typename index_type>
+index_type gs_count_range(
+        stream_text<source_type>& x,
+        string_type b, index_type m1,
+        string_type e, index_type m2,
+        index_type k)
+{
+    using namespace std;
+    detail::gs_stream_counter<source_type,string_type,index_type>
+        lc(x,b,m1,k), uc(x,e,m2,k);
+    x.require_lookback(2*max(m1,m2)+2);
+    bool lm = true, um = true;
+    while (lm || um) {
+        if (lm && (!um || lc.position() <= uc.position())) {
+            lm = lc.step();
+        } else {
+            um = uc.step();
+        }
+    }
+    index_type l = lc.count(), u = uc.count();
+    return u < l ? 0 : u - l;
+}
+
 } // rmatch
 
 #endif // GS_COUNT_HPP
@@ -72,7 +72,9 @@ void pred(const typename s_n_t<index_type>::type& s_n, index_type x,
 
 /* Auxiliary 'contains'-function in the original paper. Outputs tuple (b,e,c)
    in the list Sp with b <= x < e or (0,..) if such a tuple is not found.
-   Tuples are assumed to be non-overlapping. */
+   Tuples are assumed to be non-overlapping. The scan usually stops after a
+   couple of tuples; neither a table indexed by the bit width of x nor a
+   cursor following x through the list made the count loop faster. */
 template <typename index_type>
 void contains(const typename s_p_t<index_type>::type& s_p, index_type x,
         index_type& b, index_type& e, index_type& c)
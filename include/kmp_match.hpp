@@ -13,7 +13,11 @@
 #ifndef KMP_MATCH_HPP
 #define KMP_MATCH_HPP
 
+#include "match_length.hpp"
+#include "stream_text.hpp"
+
 #include <type_traits>
+#include <string>
 #include <vector>
 #include <memory>
 #include <algorithm>
@@ -38,10 +42,9 @@ void kmp_precompute(const string_type& p, size_type pm, lcp_type& lcp)
             l = lcp[i-j-1];
         }
         if (i+l == k) {
-            while (l < m && k < n && p[l] == p[k+1]) {
-                ++k;
-                ++l;
-            }
+            index_type e = match_length(p+l,p+k+1,std::min(m-l,n-k));
+            k += e;
+            l += e;
             j = i;
         } else if (i+l > k) {
             l = k-i;
@@ -52,23 +55,102 @@ void kmp_precompute(const string_type& p, size_type pm, lcp_type& lcp)
     }
 }
 
+/* Allocate and compute the lcp array of pattern p. */
+template <typename lcp_type, typename string_type, typename size_type>
+std::shared_ptr<const lcp_type> kmp_lcp(const string_type& p, size_type m)
+{
+    std::shared_ptr<lcp_type> lcp = std::make_shared<lcp_type>(m);
+    kmp_precompute(p,m,*lcp);
+    return lcp;
+}
+
 /* The common context for algorithm iterators sharing the same text and upper
    bound pattern. Using a pointer to this context avoids overhead when iterator
-   is being copied. */
-template <typename string_type, typename size_type>
+   is being copied. The lcp array may be shared with a compiled pattern. */
+template <typename string_type, typename size_type, typename pattern_type>
 struct kmp_match_less_iterator_context {
     typedef typename std::make_signed<size_type>::type index_type;
+    typedef std::vector<index_type> lcp_type;
     const string_type t;
-    const string_type p;
+    const pattern_type p;
     const index_type n, m;
-    std::vector<index_type> lcp;
+    const std::shared_ptr<const lcp_type> lcp;
+    kmp_match_less_iterator_context(
+            string_type t, size_type n,
+            pattern_type p, size_type m):
+        t(t), p(p), n(n), m(m), lcp(kmp_lcp<lcp_type>(p,m)) {}
     kmp_match_less_iterator_context(
             string_type t, size_type n,
+            pattern_type p, size_type m,
+            const std::shared_ptr<const lcp_type>& lcp):
+        t(t), p(p), n(n), m(m), lcp(lcp) {}
+};
+
+/* Knuth-Morris-Pratt comparison of the suffixes of a text with a pattern whose
+   lcp array has been computed. The body of kmp_match_less_iterator::next() is
+   run for one suffix at a time by less(), so that several patterns can be
+   compared over a single pass of the text. The text is a stream_text or an
+   array_text, which is only accessed at positions [i,i+m]. */
+template <typename text_type, typename pattern_type, typename index_type>
+class kmp_matcher {
+public:
+    kmp_matcher(text_type& t, pattern_type p, index_type m,
+            const std::vector<index_type>& lcp):
+        t(t), p(p), m(m), lcp(lcp), j(-1), k(-1) {}
+
+    /* Returns true, if suffix t[i..n) is smaller than the pattern. Must be
+       called for i = 0,1,...,n-1 in order. */
+    bool less(index_type i)
+    {
+        index_type l;
+        if (i > k) {
+            k = i;
+            l = 0;
+        } else {
+            l = lcp[i-j-1];
+        }
+        if (i+l == k) {
+            index_type e = t.match_length(k,p+l,m-l);
+            k += e;
+            l += e;
+            j = i;
+        } else if (i+l > k) {
+            l = k-i;
+            j = i;
+        }
+        return l != m && (!t.has(i+l) || t[i+l] < p[l]);
+    }
+
+private:
+    text_type& t;
+    const pattern_type p;
+    const index_type m;
+    const std::vector<index_type>& lcp;
+    index_type j, k;
+};
+
+/* Knuth-Morris-Pratt comparison of the suffixes of a streamed text with a
+   pattern, which computes the lcp array of its own. */
+template <typename source_type, typename string_type, typename size_type>
+class kmp_stream_matcher {
+public:
+    typedef typename std::make_signed<size_type>::type index_type;
+
+    kmp_stream_matcher(stream_text<source_type>& t,
             string_type p, size_type m):
-        t(t), p(p), n(n), m(m), lcp(m)
+        lcp(m), matcher(t,p,m,lcp)
     {
         kmp_precompute(p,m,lcp);
+        t.require_lookback(m+1);
     }
+
+    /* Returns true, if suffix t[i..n) is smaller than the pattern. Must be
+       called for i = 0,1,...,n-1 in order. */
+    bool less(index_type i) { return matcher.less(i); }
+
+private:
+    std::vector<index_type> lcp;
+    kmp_matcher<stream_text<source_type>,string_type,index_type> matcher;
 };
 
 } // detail
@@ -97,11 +179,12 @@ struct kmp_match_less_iterator_context {
  * extra space.
  */
 
-template <typename string_type, typename size_type>
+template <typename string_type, typename size_type,
+         typename pattern_type = string_type>
 class kmp_match_less_iterator {
 public:
-    typedef detail::kmp_match_less_iterator_context<string_type,size_type>
-        context;
+    typedef detail::kmp_match_less_iterator_context<
+        string_type,size_type,pattern_type> context;
     typedef typename std::make_signed<size_type>::type index_type;
 
     /* typedefs required for stl iterators. */
@@ -124,7 +207,25 @@ public:
             string_type t, size_type n,
             string_type p, size_type m):
         ctx(std::make_shared<context>(t,n,p,m)),
-        i(0), j(-1), k(-1) { next(); }
+        i(0), j(-1), k(-1), l(0), v(0) { next(); }
+
+    /**
+     * Construct a string range matching algorithm iterator with the given text
+     * t and a pattern p whose lcp array has already been computed.
+     *
+     * @param t Input text. (random access iterator)
+     * @param n Size of the input text.
+     * @param p Input pattern. (random access iterator)
+     * @param m Size of the input pattern.
+     * @param lcp Array of lcp(p,p[i..m)) for all i ∈ [1,m] computed by
+     * kmp_precompute(). (shared)
+     */
+    kmp_match_less_iterator(
+            string_type t, size_type n,
+            pattern_type p, size_type m,
+            const std::shared_ptr<const typename context::lcp_type>& lcp):
+        ctx(std::make_shared<context>(t,n,p,m,lcp)),
+        i(0), j(-1), k(-1), l(0), v(0) { next(); }
 
     /**
      * Inequality comparison between operators. Compared iterators are assumed
@@ -200,8 +301,8 @@ private:
         const index_type n = ctx->n;
         const index_type m = ctx->m;
         const string_type t = ctx->t;
-        const string_type p = ctx->p;
-        const std::vector<index_type>& lcp = ctx->lcp;
+        const pattern_type p = ctx->p;
+        const std::vector<index_type>& lcp = *ctx->lcp;
 
         while (i <= n) {
             // t[i,n) is the suffix being compared to p
@@ -215,6 +316,8 @@ private:
                 l = lcp[i-j-1];
             }
             if (i+l == k) {
+                // extensions past k are short on most texts, and a plain loop
+                // keeps next() small enough to be inlined into the caller
                 while (l < m && k < n && p[l] == t[k]) {
                     ++k;
                     ++l;
@@ -244,7 +347,7 @@ private:
      * @param i Length of the text of the iterator this iterator is to be
      * compared with.
      */
-    kmp_match_less_iterator(size_type i): i(i) {}
+    kmp_match_less_iterator(size_type i): i(i), j(-1), k(-1), l(0), v(0) {}
 
     const std::shared_ptr<const context> ctx;
     index_type i, j, k, l;
@@ -299,6 +402,120 @@ void kmp_match_range(
             r);
 }
 
+/**
+ * @brief Pattern compiled for Knuth-Morris-Pratt matching.
+ *
+ * Holds a copy of the pattern together with its lcp array, so that the same
+ * pattern can be matched against many texts without repeating the O(m)
+ * precomputation. The object is immutable and can be shared between threads.
+ * It must outlive the iterators created from it.
+ */
+template <typename size_type = size_t>
+class kmp_pattern {
+public:
+    typedef std::string::const_iterator iterator;
+    typedef typename std::make_signed<size_type>::type index_type;
+    typedef std::vector<index_type> lcp_type;
+
+    /**
+     * @param p Pattern.
+     */
+    explicit kmp_pattern(const std::string& p):
+        p(p), lcp(detail::kmp_lcp<lcp_type>(begin(),size())) {}
+
+    /**
+     * @return Beginning of the pattern.
+     */
+    iterator begin() const { return p.begin(); }
+
+    /**
+     * @return Length of the pattern.
+     */
+    size_type size() const { return p.size(); }
+
+    /**
+     * @return Array of lcp(p,p[i..m)) for all i ∈ [1,m].
+     */
+    const lcp_type& lcps() const { return *lcp; }
+
+    /**
+     * Create an iterator over the indices of the suffixes of a text that are
+     * lexicographically smaller than the pattern.
+     *
+     * @param t Input text. (random access iterator)
+     * @param n Size of the input text.
+     * @return Iterator at the first matching index.
+     */
+    template <typename string_type>
+    kmp_match_less_iterator<string_type,size_type,iterator>
+    less(string_type t, size_type n) const
+    {
+        return kmp_match_less_iterator<string_type,size_type,iterator>(
+                t,n,begin(),size(),lcp);
+    }
+
+private:
+    const std::string p;
+    const std::shared_ptr<const lcp_type> lcp;
+};
+
+/**
+ * Calculate indices i of suffixes t[i..n) of text t that are lexicographically
+ * larger or equal to compiled pattern l and smaller than compiled pattern u;
+ * i.e. l <= t < u.
+ *
+ * @param t Input text. (random access iterator)
+ * @param n Size of the input text.
+ * @param l Compiled lower bound pattern.
+ * @param u Compiled upper bound pattern.
+ * @param r Destination index sequence. (output iterator)
+ */
+template <typename string_type, typename size_type, typename output_iterator>
+void kmp_match_range(
+        string_type t, size_type n,
+        const kmp_pattern<size_type>& l,
+        const kmp_pattern<size_type>& u,
+        output_iterator r)
+{
+    auto li = l.less(t,n);
+    auto ui = u.less(t,n);
+    std::set_difference(ui,ui.end(),li,li.end(),r);
+}
+
+/**
+ * Calculate indices i of suffixes t[i..n) of a streamed text t that are
+ * lexicographically larger or equal to pattern l and smaller than pattern u;
+ * i.e. l <= t < u. Both patterns are compared during a single pass over the
+ * text and the indices are written in increasing order as soon as they are
+ * found. Only O(lm+um) extra space and a window of max(lm,um)+1 characters of
+ * the text are kept in memory.
+ *
+ * @param t Input text, which is read to its end.
+ * @param l Lower bound pattern. (random access iterator)
+ * @param lm Size of the lower bound pattern.
+ * @param u Upper bound pattern. (random access iterator)
+ * @param um Size of the upper bound pattern.
+ * @param r Destination index sequence. (output iterator)
+ */
+template <typename source_type, typename string_type, typename size_type,
+         typename output_iterator>
+void kmp_match_range(
+        stream_text<source_type>& t,
+        string_type l, size_type lm,
+        string_type u, size_type um,
+        output_iterator r)
+{
+    typedef detail::kmp_stream_matcher<source_type,string_type,size_type>
+        matcher;
+    matcher lk(t,l,lm), uk(t,u,um);
+    for (size_type i = 0; t.has(i); ++i) {
+        // both matchers must see every suffix
+        const bool less_u = uk.less(i);
+        const bool less_l = lk.less(i);
+        if (less_u && !less_l) *r++ = i;
+    }
+}
+
 } // rmatch
 
 #endif // KMP_MATCH_HPP
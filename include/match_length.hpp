@@ -0,0 +1,174 @@
+/*
+ * Longest common prefix extension used in the inner loops of the linear time
+ * algorithms. Contiguous byte strings are compared 16, 32 or 64 bytes at a time
+ * with SSE2 or AVX2 instructions selected at runtime; other strings are
+ * compared one element at a time.
+ *
+ * Copyright (c) 2015 Jarno Leppänen
+ */
+
+#ifndef MATCH_LENGTH_HPP
+#define MATCH_LENGTH_HPP
+
+#include "simd.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <type_traits>
+#include <cstdint>
+#include <cstddef>
+
+namespace rmatch {
+namespace detail {
+
+/* Trait telling whether an iterator points to contiguous characters, so that
+   &*it can be used as a character array. */
+template <typename iterator>
+struct is_byte_iterator: std::false_type {};
+
+template <>
+struct is_byte_iterator<const char*>: std::true_type {};
+
+template <>
+struct is_byte_iterator<char*>: std::true_type {};
+
+#ifdef __GLIBCXX__
+/* Iterators of std::basic_string<char> and std::vector<char>. */
+template <typename container>
+struct is_byte_iterator<__gnu_cxx::__normal_iterator<const char*,container>>:
+    std::true_type {};
+
+template <typename container>
+struct is_byte_iterator<__gnu_cxx::__normal_iterator<char*,container>>:
+    std::true_type {};
+#endif
+
+/* Length of the longest common prefix of a[0..max) and b[0..max) comparing
+   one character at a time. */
+inline size_t match_length_scalar(const char *a, const char *b, size_t max)
+{
+    size_t i = 0;
+    while (i < max && a[i] == b[i]) ++i;
+    return i;
+}
+
+#ifdef RMATCH_X86_SIMD
+
+/* Length of the longest common prefix of a[0..max) and b[0..max) comparing
+   16 characters at a time. */
+__attribute__((target("sse2")))
+inline size_t match_length_sse2(const char *a, const char *b, size_t max)
+{
+    size_t i = 0;
+    for (; i+16 <= max; i += 16) {
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a+i));
+        const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b+i));
+        const uint32_t eq = _mm_movemask_epi8(_mm_cmpeq_epi8(x,y));
+        if (eq != 0xffff) return i + __builtin_ctz(~eq);
+    }
+    return i + match_length_scalar(a+i,b+i,max-i);
+}
+
+/* Length of the longest common prefix of a[0..max) and b[0..max) comparing
+   64 and 32 characters at a time. */
+__attribute__((target("avx2")))
+inline size_t match_length_avx2(const char *a, const char *b, size_t max)
+{
+    typedef const __m256i* vp;
+    size_t i = 0;
+    for (; i+64 <= max; i += 64) {
+        const __m256i x0 = _mm256_loadu_si256(reinterpret_cast<vp>(a+i));
+        const __m256i y0 = _mm256_loadu_si256(reinterpret_cast<vp>(b+i));
+        const __m256i x1 = _mm256_loadu_si256(reinterpret_cast<vp>(a+i+32));
+        const __m256i y1 = _mm256_loadu_si256(reinterpret_cast<vp>(b+i+32));
+        const uint32_t eq0 = _mm256_movemask_epi8(_mm256_cmpeq_epi8(x0,y0));
+        const uint32_t eq1 = _mm256_movemask_epi8(_mm256_cmpeq_epi8(x1,y1));
+        if (eq0 != ~uint32_t(0)) return i + __builtin_ctz(~eq0);
+        if (eq1 != ~uint32_t(0)) return i + 32 + __builtin_ctz(~eq1);
+    }
+    if (i+32 <= max) {
+        const __m256i x = _mm256_loadu_si256(reinterpret_cast<vp>(a+i));
+        const __m256i y = _mm256_loadu_si256(reinterpret_cast<vp>(b+i));
+        const uint32_t eq = _mm256_movemask_epi8(_mm256_cmpeq_epi8(x,y));
+        if (eq != ~uint32_t(0)) return i + __builtin_ctz(~eq);
+        i += 32;
+    }
+    return i + match_length_sse2(a+i,b+i,max-i);
+}
+
+#endif
+
+/* Length of the longest common prefix of character arrays a[0..max) and
+   b[0..max) using the widest comparisons supported by the processor. This is
+   kept out of line so that the scalar fast path stays small enough to be
+   inlined into the scanning loops. */
+__attribute__((noinline, pure))
+inline size_t match_length_wide(const char *a, const char *b, size_t max)
+{
+#ifdef RMATCH_X86_SIMD
+    if (has_avx2()) return match_length_avx2(a,b,max);
+    return match_length_sse2(a,b,max);
+#else
+    return match_length_scalar(a,b,max);
+#endif
+}
+
+/* Common prefixes shorter than this are extended one character at a time. */
+const size_t match_length_scalar_prefix = 16;
+
+/* Length of the longest common prefix of character arrays a[0..max) and
+   b[0..max). Characters are compared one at a time until the common prefix
+   turns out to be long. */
+inline size_t match_length_bytes(const char *a, const char *b, size_t max)
+{
+    // most mismatches happen within the first few characters, where a vector
+    // compare would only add latency
+    size_t i = 0;
+    while (i < max && a[i] == b[i]) {
+        if (++i == match_length_scalar_prefix) {
+            return i + match_length_wide(a+i,b+i,max-i);
+        }
+    }
+    return i;
+}
+
+template <typename iterator_a, typename iterator_b, typename size_type>
+size_type match_length(iterator_a a, iterator_b b, size_type max,
+        std::true_type)
+{
+    if (max <= 0) return 0;
+    return match_length_bytes(&*a,&*b,max);
+}
+
+template <typename iterator_a, typename iterator_b, typename size_type>
+size_type match_length(iterator_a a, iterator_b b, size_type max,
+        std::false_type)
+{
+    size_type i = 0;
+    while (i < max && a[i] == b[i]) ++i;
+    return i;
+}
+
+/**
+ * Calculate the length of the longest common prefix of a[0..max) and
+ * b[0..max). Contiguous character strings are compared with SIMD
+ * instructions.
+ *
+ * @param a First string. (random access iterator)
+ * @param b Second string. (random access iterator)
+ * @param max Maximum length of the common prefix.
+ * @return Length of the longest common prefix.
+ */
+template <typename iterator_a, typename iterator_b, typename size_type>
+size_type match_length(iterator_a a, iterator_b b, size_type max)
+{
+    typedef std::integral_constant<bool,
+            is_byte_iterator<iterator_a>::value &&
+            is_byte_iterator<iterator_b>::value> bytes;
+    return match_length(a,b,max,bytes());
+}
+
+} // detail
+} // rmatch
+
+#endif // MATCH_LENGTH_HPP
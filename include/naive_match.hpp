@@ -7,10 +7,17 @@
 #ifndef NAIVE_MATCH_HPP
 #define NAIVE_MATCH_HPP
 
+#include "simd.hpp"
+
 #include <algorithm>
 #include <string>
+#include <vector>
 #include <iterator>
 #include <type_traits>
+#include <limits>
+#include <thread>
+#include <cstdint>
+#include <cstddef>
 
 namespace rmatch {
 
@@ -44,6 +51,190 @@ void naive_match_range(
     }
 }
 
+namespace detail {
+
+/* Texts shorter than this per thread are not split between threads. */
+const size_t naive_min_chunk = 1 << 16;
+
+/* Output indices i ∈ [b,e) of suffixes t[i..n) with l <= t[i..n) < u
+   comparing one suffix at a time. */
+template <typename output_iterator>
+void naive_match_scalar(
+        const char *t, size_t n, size_t b, size_t e,
+        const char *l, size_t lm,
+        const char *u, size_t um,
+        output_iterator& r)
+{
+    using namespace std;
+    for (size_t i = b; i < e; ++i) {
+        if (
+                 lexicographical_compare(t+i,t+n,u,u+um) &&
+                !lexicographical_compare(t+i,t+n,l,l+lm)) *r++ = i;
+    }
+}
+
+#ifdef RMATCH_X86_SIMD
+
+/* Bit mask of the 32 suffixes t[j..) for j ∈ [0,32) that are lexicographically
+   smaller than pattern p. Character j of every suffix is compared at once, so
+   the loop runs only until all suffixes have found a mismatch. All suffixes
+   are assumed to be at least m characters long. */
+__attribute__((target("avx2")))
+inline uint32_t naive_less_mask_avx2(const char *t, const char *p, size_t m)
+{
+    // unsigned characters are compared as signed after flipping the sign bit
+    const char sign = std::numeric_limits<char>::is_signed ? 0 : -128;
+    const __m256i flip = _mm256_set1_epi8(sign);
+    uint32_t undecided = ~uint32_t(0), less = 0;
+    for (size_t j = 0; j < m && undecided; ++j) {
+        const __m256i v = _mm256_xor_si256(flip,
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(t+j)));
+        const __m256i c = _mm256_set1_epi8(p[j] ^ sign);
+        const uint32_t eq = _mm256_movemask_epi8(_mm256_cmpeq_epi8(v,c));
+        const uint32_t lt = _mm256_movemask_epi8(_mm256_cmpgt_epi8(c,v));
+        less |= undecided & lt;
+        undecided &= eq;
+    }
+    // suffixes still undecided have the pattern as a prefix
+    return less;
+}
+
+/* Output indices i ∈ [b,e) of suffixes t[i..n) with l <= t[i..n) < u
+   comparing 32 suffixes at a time with AVX2. */
+template <typename output_iterator>
+__attribute__((target("avx2")))
+void naive_match_avx2(
+        const char *t, size_t n, size_t b, size_t e,
+        const char *l, size_t lm,
+        const char *u, size_t um,
+        output_iterator& r)
+{
+    const size_t m = std::max(lm,um);
+    size_t i = b;
+    // vector loads must stay within the text, which also guarantees that no
+    // suffix ends before the patterns
+    for (; i+32 <= e && i+m+31 <= n; i += 32) {
+        uint32_t mask = naive_less_mask_avx2(t+i,u,um);
+        if (!mask) continue;
+        mask &= ~naive_less_mask_avx2(t+i,l,lm);
+        while (mask) {
+            *r++ = i + __builtin_ctz(mask);
+            mask &= mask-1;
+        }
+    }
+    naive_match_scalar(t,n,i,e,l,lm,u,um,r);
+}
+
+#endif
+
+/* Output indices i ∈ [b,e) of suffixes t[i..n) with l <= t[i..n) < u using
+   the fastest kernel supported by the processor. */
+template <typename output_iterator>
+void naive_match_chunk(
+        const char *t, size_t n, size_t b, size_t e,
+        const char *l, size_t lm,
+        const char *u, size_t um,
+        output_iterator& r)
+{
+#ifdef RMATCH_X86_SIMD
+    if (has_avx2()) {
+        naive_match_avx2(t,n,b,e,l,lm,u,um,r);
+        return;
+    }
+#endif
+    naive_match_scalar(t,n,b,e,l,lm,u,um,r);
+}
+
+/* Default number of threads for the naive search. */
+inline unsigned naive_threads()
+{
+    unsigned c = std::thread::hardware_concurrency();
+    return c ? c : 1;
+}
+
+} // detail
+
+/**
+ * Calculate indices i of suffixes t[i..n) of a contiguous byte text t that are
+ * lexicographically larger or equal to pattern l and smaller than pattern u;
+ * i.e. l <= t < u.
+ *
+ * This is a specialized version of the naive search for character arrays. It
+ * compares 32 suffixes at a time with AVX2 instructions if the processor
+ * supports them. Short bounds make this fast, as all 32 suffixes usually
+ * mismatch within the first few characters. The text is split into chunks
+ * that are searched in parallel threads. The indices of the first chunk are
+ * written directly to the output, the others are buffered until their thread
+ * finishes.
+ *
+ * @param t Input text.
+ * @param n Size of the input text.
+ * @param l Lower bound pattern.
+ * @param lm Size of the lower bound pattern.
+ * @param u Upper bound pattern.
+ * @param um Size of the upper bound pattern.
+ * @param r Destination index sequence. (output iterator)
+ * @param threads Maximum number of threads to use.
+ */
+template <typename output_iterator>
+void naive_match_range(
+        const char *t, size_t n,
+        const char *l, size_t lm,
+        const char *u, size_t um,
+        output_iterator r,
+        unsigned threads)
+{
+    using namespace std;
+    using namespace rmatch::detail;
+    threads = max(1u,min<unsigned>(threads,n/naive_min_chunk));
+    if (threads == 1) {
+        naive_match_chunk(t,n,0,n,l,lm,u,um,r);
+        return;
+    }
+    // chunk boundaries are aligned to whole vector blocks
+    const size_t step = ((n+threads-1)/threads+31) & ~size_t(31);
+    vector<vector<size_t>> parts(threads);
+    vector<thread> workers;
+    for (unsigned k = 1; k < threads; ++k) {
+        workers.push_back(thread([=,&parts]() {
+            back_insert_iterator<vector<size_t>> o(parts[k]);
+            naive_match_chunk(t,n,min(n,k*step),min(n,(k+1)*step),
+                    l,lm,u,um,o);
+        }));
+    }
+    naive_match_chunk(t,n,0,min(n,step),l,lm,u,um,r);
+    for (unsigned k = 1; k < threads; ++k) {
+        workers[k-1].join();
+        r = copy(parts[k].begin(),parts[k].end(),r);
+        vector<size_t>().swap(parts[k]);
+    }
+}
+
+/**
+ * Calculate indices i of suffixes t[i..n) of text t that are lexicographically
+ * larger or equal to pattern l and smaller than pattern u; i.e. l <= t < u.
+ *
+ * Specialization for character arrays, which uses the vectorized parallel
+ * search with all available hardware threads.
+ *
+ * @param t Input text.
+ * @param te End position of input text.
+ * @param l Lower bound pattern.
+ * @param le End position of the lower bound pattern.
+ * @param u Upper bound pattern.
+ * @param le End position of the upper bound pattern.
+ * @param r Destination index sequence. (output iterator)
+ */
+template <typename output_iterator>
+void naive_match_range(
+        const char *t, const char *te,
+        const char *l, const char *le,
+        const char *u, const char *ue,
+        output_iterator r)
+{
+    naive_match_range(t,te-t,l,le-l,u,ue-u,r,detail::naive_threads());
+}
+
 /**
  * Calculate indices i of suffixes t[i..n) of text t that are lexicographically
  * larger or equal to pattern l and smaller than pattern u; i.e. l <= t < u.
@@ -67,6 +258,32 @@ void naive_match_range(
             r);
 }
 
+/**
+ * Calculate indices i of suffixes t[i..n) of text t that are lexicographically
+ * larger or equal to pattern l and smaller than pattern u; i.e. l <= t < u.
+ *
+ * Specialization for character strings, which uses the vectorized parallel
+ * search with all available hardware threads.
+ *
+ * @param t Input text. (character string)
+ * @param l Lower bound pattern. (character string)
+ * @param u Upper bound pattern. (character string)
+ * @param r Destination index sequence. (output iterator)
+ */
+template <typename traits, typename allocator, typename output_iterator>
+void naive_match_range(
+        const std::basic_string<char,traits,allocator>& t,
+        const std::basic_string<char,traits,allocator>& b,
+        const std::basic_string<char,traits,allocator>& e,
+        output_iterator r)
+{
+    naive_match_range(
+            t.data(), t.size(),
+            b.data(), b.size(),
+            e.data(), e.size(),
+            r, detail::naive_threads());
+}
+
 } // rmatch
 
 #endif
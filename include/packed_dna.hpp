@@ -0,0 +1,405 @@
+/*
+ * A text of nucleotides A, C, G and T packed into two bits per base. The
+ * bases are coded in their alphabetical order, so that packed texts compare
+ * the same way as the character strings they were packed from, and common
+ * prefixes of packed texts are found by comparing 32 bases per 64-bit word.
+ *
+ * Copyright (c) 2015 Jarno Leppänen
+ */
+
+#ifndef PACKED_DNA_HPP
+#define PACKED_DNA_HPP
+
+#include "match_length.hpp"
+#include "naive_match.hpp"
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <cstdint>
+#include <cstddef>
+
+namespace rmatch {
+namespace detail {
+
+/* Bases of a packed text in the order of their codes. */
+const char packed_dna_bases[] = "ACGT";
+
+/* Code of base c, or 4 if c is not one of A, C, G or T. */
+inline unsigned packed_dna_code(char c)
+{
+    switch (c) {
+        case 'A': return 0;
+        case 'C': return 1;
+        case 'G': return 2;
+        case 'T': return 3;
+        default: return 4;
+    }
+}
+
+/* Code of base c to be packed. Throws std::invalid_argument if c is not one
+   of A, C, G or T. */
+inline uint64_t packed_dna_pack_code(char c)
+{
+    const unsigned code = packed_dna_code(c);
+    if (code > 3) {
+        throw std::invalid_argument(
+                std::string("Cannot pack character ") + c + " as a base");
+    }
+    return code;
+}
+
+/* Random access iterator over the bases of a packed text. Base i is stored in
+   bits [2*(i%32),2*(i%32)+2) of word i/32. */
+class packed_dna_iterator {
+public:
+    typedef char value_type;
+    typedef ptrdiff_t difference_type;
+    typedef const char* pointer;
+    typedef char reference;
+    typedef std::random_access_iterator_tag iterator_category;
+
+    packed_dna_iterator(): w(nullptr), i(0) {}
+    packed_dna_iterator(const uint64_t *w, size_t i): w(w), i(i) {}
+
+    /* Code of the base at the iterator. */
+    unsigned code() const { return code(0); }
+    unsigned code(difference_type d) const
+    {
+        const size_t j = i+d;
+        return (w[j/32] >> (2*(j%32))) & 3;
+    }
+
+    /* The 32 bases starting at the iterator packed into a word, with the
+       first base in the lowest bits. Bases past the end of the text are
+       zero. */
+    uint64_t word() const
+    {
+        const size_t o = i%32;
+        const uint64_t *p = w + i/32;
+        return o ? (p[0] >> (2*o)) | (p[1] << (64-2*o)) : p[0];
+    }
+
+    char operator*() const { return packed_dna_bases[code()]; }
+    char operator[](difference_type d) const
+    {
+        return packed_dna_bases[code(d)];
+    }
+
+    packed_dna_iterator& operator++() { ++i; return *this; }
+    packed_dna_iterator& operator--() { --i; return *this; }
+    packed_dna_iterator operator++(int) { return packed_dna_iterator(w,i++); }
+    packed_dna_iterator operator--(int) { return packed_dna_iterator(w,i--); }
+    packed_dna_iterator& operator+=(difference_type d) { i += d; return *this; }
+    packed_dna_iterator& operator-=(difference_type d) { i -= d; return *this; }
+    packed_dna_iterator operator+(difference_type d) const
+    {
+        return packed_dna_iterator(w,i+d);
+    }
+    packed_dna_iterator operator-(difference_type d) const
+    {
+        return packed_dna_iterator(w,i-d);
+    }
+    difference_type operator-(const packed_dna_iterator& o) const
+    {
+        return difference_type(i) - difference_type(o.i);
+    }
+
+    bool operator==(const packed_dna_iterator& o) const { return i == o.i; }
+    bool operator!=(const packed_dna_iterator& o) const { return i != o.i; }
+    bool operator<(const packed_dna_iterator& o) const { return i < o.i; }
+    bool operator>(const packed_dna_iterator& o) const { return i > o.i; }
+    bool operator<=(const packed_dna_iterator& o) const { return i <= o.i; }
+    bool operator>=(const packed_dna_iterator& o) const { return i >= o.i; }
+
+private:
+    const uint64_t *w;
+    size_t i;
+};
+
+inline packed_dna_iterator operator+(ptrdiff_t d, packed_dna_iterator it)
+{
+    return it + d;
+}
+
+/**
+ * Calculate the length of the longest common prefix of packed texts a[0..max)
+ * and b[0..max) comparing 32 bases at a time.
+ *
+ * @param a First text.
+ * @param b Second text.
+ * @param max Maximum length of the common prefix.
+ * @return Length of the longest common prefix.
+ */
+template <typename size_type>
+size_type match_length(packed_dna_iterator a, packed_dna_iterator b,
+        size_type max)
+{
+    if (max <= 0) return 0;
+    size_type i = 0;
+    while (i < max) {
+        const uint64_t x = a.word() ^ b.word();
+        if (x) return std::min<size_type>(max, i + __builtin_ctzll(x)/2);
+        i += 32;
+        a += 32;
+        b += 32;
+    }
+    return max;
+}
+
+/* Returns true, if packed text a[0..n) is lexicographically smaller than
+   packed text b[0..m). The first 32 bases are compared with a single word
+   comparison. */
+inline bool packed_dna_less(packed_dna_iterator a, size_t n,
+        packed_dna_iterator b, size_t m)
+{
+    const size_t c = std::min(n,m);
+    const uint64_t x = a.word(), y = b.word();
+    uint64_t d = x ^ y;
+    if (c < 32) d &= (uint64_t(1) << 2*c) - 1;
+    size_t l;
+    if (d) {
+        const unsigned s = __builtin_ctzll(d) & ~1u;
+        return ((x >> s) & 3) < ((y >> s) & 3);
+    } else if (c <= 32) {
+        l = c;
+    } else {
+        l = 32 + match_length(a+32,b+32,c-32);
+    }
+    return l < m && (l == n || a.code(l) < b.code(l));
+}
+
+/* Bit mask of the 32 suffixes t[j..) for j ∈ [0,32) that are lexicographically
+   smaller than pattern p[0..m), with suffix j in bit 2j. Base j of every
+   suffix is one of the bases of the word at t+j, so the 32 suffixes are
+   compared with the pattern base by base using bitwise operations on 2-bit
+   fields. All suffixes are assumed to be at least m bases long. */
+inline uint64_t packed_dna_less_mask(packed_dna_iterator t,
+        packed_dna_iterator p, size_t m)
+{
+    const uint64_t lo = 0x5555555555555555ull;
+    uint64_t undecided = lo, less = 0;
+    for (size_t j = 0; j < m && undecided; ++j) {
+        const uint64_t w = (t+j).word();
+        const unsigned c = p.code(j);
+        // high and low bits of the codes of the text and of the pattern base
+        const uint64_t th = (w >> 1) & lo, tl = w & lo;
+        const uint64_t ph = c & 2 ? lo : 0, pl = c & 1 ? lo : 0;
+        const uint64_t eqh = ~(th ^ ph) & lo;
+        less |= undecided & ((~th & ph) | (eqh & ~tl & pl));
+        undecided &= eqh & ~(tl ^ pl);
+    }
+    // suffixes still undecided have the pattern as a prefix
+    return less;
+}
+
+} // detail
+
+/**
+ * @brief Text of nucleotides packed into two bits per base.
+ *
+ * The class has the interface of a string of characters A, C, G and T that
+ * bases can be appended and inserted to, so it can be used as the text and the
+ * patterns of the algorithms of the library in place of a std::string. Its
+ * iterators read the bases in their packed form, and the common prefixes of
+ * packed texts are extended 32 bases at a time.
+ */
+template <typename allocator = std::allocator<uint64_t>>
+class basic_packed_dna {
+public:
+    typedef char value_type;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+    typedef detail::packed_dna_iterator const_iterator;
+    typedef const_iterator iterator;
+
+    basic_packed_dna(): n(0), words(1) {}
+
+    /**
+     * Pack a string of bases. Throws std::invalid_argument if the string is
+     * not packable().
+     *
+     * @param b Beginning of the bases. (input iterator)
+     * @param e End of the bases. (input iterator)
+     */
+    template <typename input_iterator>
+    basic_packed_dna(input_iterator b, input_iterator e): n(0), words(1)
+    {
+        insert(end(),b,e);
+    }
+
+    /**
+     * Pack a string of bases. Throws std::invalid_argument if the string is
+     * not packable().
+     *
+     * @param s Bases. (container)
+     */
+    template <typename string_type>
+    explicit basic_packed_dna(const string_type& s): n(0), words(1)
+    {
+        insert(end(),s.begin(),s.end());
+    }
+
+    /**
+     * Check whether a string can be packed.
+     *
+     * @param b Beginning of the string. (input iterator)
+     * @param e End of the string. (input iterator)
+     * @return True, if the string consists of characters A, C, G and T only.
+     */
+    template <typename input_iterator>
+    static bool packable(input_iterator b, input_iterator e)
+    {
+        for (; b != e; ++b) {
+            if (detail::packed_dna_code(*b) > 3) return false;
+        }
+        return true;
+    }
+
+    /**
+     * Append a base.
+     *
+     * @param c One of the characters A, C, G and T; std::invalid_argument is
+     * thrown for other characters.
+     */
+    void push_back(char c)
+    {
+        const uint64_t code = detail::packed_dna_pack_code(c);
+        // one word past the last base is kept so that word() never reads
+        // past the array
+        if (n/32+2 > words.size()) words.resize(words.size()*2+1);
+        words[n/32] |= code << (2*(n%32));
+        ++n;
+    }
+
+    /**
+     * Insert bases. Inserting at the end appends the bases in place; elsewhere
+     * the bases after the position are unpacked and packed again after the
+     * inserted ones. Throws std::invalid_argument if the bases are not
+     * packable(), leaving the text as it was.
+     *
+     * @param pos Position of the first inserted base.
+     * @param b Beginning of the bases. (input iterator)
+     * @param e End of the bases. (input iterator)
+     */
+    template <typename input_iterator>
+    void insert(const_iterator pos, input_iterator b, input_iterator e)
+    {
+        const size_type i = pos-begin();
+        const std::string tail(pos,end());
+        truncate(i);
+        try {
+            append(b,e,typename
+                    std::iterator_traits<input_iterator>::iterator_category());
+        } catch (const std::invalid_argument&) {
+            truncate(i);
+            append(tail.begin(),tail.end(),std::forward_iterator_tag());
+            throw;
+        }
+        append(tail.begin(),tail.end(),std::forward_iterator_tag());
+    }
+
+    /**
+     * Release unused capacity.
+     */
+    void shrink_to_fit()
+    {
+        words.resize(n/32+2);
+        words.shrink_to_fit();
+    }
+
+    size_type size() const { return n; }
+    size_type length() const { return n; }
+    bool empty() const { return n == 0; }
+    const_iterator begin() const { return const_iterator(words.data(),0); }
+    const_iterator end() const { return const_iterator(words.data(),n); }
+    char operator[](size_type i) const { return begin()[i]; }
+
+    /**
+     * @return The bases as a character string.
+     */
+    std::string str() const { return std::string(begin(),end()); }
+
+private:
+    /* Remove the bases from position i on, clearing their bits so that they
+       can be overwritten. */
+    void truncate(size_type i)
+    {
+        if (i == n) return;
+        if (i%32) words[i/32] &= (uint64_t(1) << 2*(i%32)) - 1;
+        else words[i/32] = 0;
+        std::fill(words.begin()+i/32+1,words.begin()+n/32+1,0);
+        n = i;
+    }
+
+    template <typename input_iterator>
+    void append(input_iterator b, input_iterator e, std::input_iterator_tag)
+    {
+        for (; b != e; ++b) push_back(*b);
+    }
+
+    /* Append a known number of bases without checking the capacity for
+       each of them. */
+    template <typename forward_iterator>
+    void append(forward_iterator b, forward_iterator e,
+            std::forward_iterator_tag)
+    {
+        const size_type c = n + std::distance(b,e);
+        if (c/32+2 > words.size()) words.resize(c/32+2);
+        for (; b != e; ++b, ++n) {
+            const uint64_t code = detail::packed_dna_pack_code(*b);
+            words[n/32] |= code << (2*(n%32));
+        }
+    }
+
+    size_type n;
+    std::vector<uint64_t,allocator> words;
+};
+
+typedef basic_packed_dna<> packed_dna;
+
+/**
+ * Calculate indices i of suffixes t[i..n) of a packed text t that are
+ * lexicographically larger or equal to pattern l and smaller than pattern u;
+ * i.e. l <= t < u. Like the vectorized search of byte texts, 32 suffixes are
+ * compared with the patterns at a time, one base of each suffix per word
+ * operation.
+ *
+ * @param t Input text.
+ * @param l Lower bound pattern.
+ * @param u Upper bound pattern.
+ * @param r Destination index sequence. (output iterator)
+ */
+template <typename allocator, typename output_iterator>
+void naive_match_range(
+        const basic_packed_dna<allocator>& t,
+        const basic_packed_dna<allocator>& l,
+        const basic_packed_dna<allocator>& u,
+        output_iterator r)
+{
+    using namespace rmatch::detail;
+    const size_t n = t.size();
+    const size_t m = std::max(l.size(),u.size());
+    size_t i = 0;
+    for (; i+m+31 <= n; i += 32) {
+        uint64_t mask = packed_dna_less_mask(t.begin()+i,u.begin(),u.size());
+        if (!mask) continue;
+        mask &= ~packed_dna_less_mask(t.begin()+i,l.begin(),l.size());
+        while (mask) {
+            *r++ = i + __builtin_ctzll(mask)/2;
+            mask &= mask-1;
+        }
+    }
+    for (; i < n; ++i) {
+        const packed_dna_iterator s = t.begin()+i;
+        if (packed_dna_less(s,n-i,u.begin(),u.size()) &&
+                !packed_dna_less(s,n-i,l.begin(),l.size())) *r++ = i;
+    }
+}
+
+} // rmatch
+
+#endif // PACKED_DNA_HPP
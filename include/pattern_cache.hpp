@@ -0,0 +1,134 @@
+/*
+ * A least recently used cache of compiled patterns keyed by the pattern bytes,
+ * so that jobs applying the same boundary patterns to many texts compile each
+ * pattern only once.
+ *
+ * Copyright (c) 2015 Jarno Leppänen
+ */
+
+#ifndef PATTERN_CACHE_HPP
+#define PATTERN_CACHE_HPP
+
+#include <string>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <functional>
+#include <utility>
+#include <algorithm>
+#include <cstddef>
+
+namespace rmatch {
+
+/**
+ * @brief Thread-safe LRU cache of compiled patterns.
+ *
+ * Compiled patterns such as gs_pattern and kmp_pattern are created from the
+ * pattern bytes by a factory when they are first requested and kept until the
+ * cache is full, after which the least recently requested pattern is evicted.
+ * Patterns are handed out as shared pointers, so an evicted pattern stays
+ * valid for as long as it is in use.
+ */
+template <typename compiled_type>
+class pattern_cache {
+public:
+    typedef std::shared_ptr<const compiled_type> pointer;
+    typedef std::function<pointer(const std::string&)> factory;
+
+    /**
+     * @param capacity Maximum number of patterns kept; at least 1.
+     * @param make Function compiling a pattern. By default the pattern is
+     * compiled with the constructor compiled_type(const std::string&).
+     */
+    explicit pattern_cache(size_t capacity, factory make = default_factory()):
+        capacity(std::max<size_t>(capacity,1)), make(make), hit(0), miss(0) {}
+
+    pattern_cache(const pattern_cache&) = delete;
+    pattern_cache& operator=(const pattern_cache&) = delete;
+
+    /**
+     * Retrieve a compiled pattern, compiling it if it is not in the cache.
+     * Compiling is done without holding the lock, so that threads requesting
+     * different patterns do not wait for each other.
+     *
+     * @param p Pattern.
+     * @return Compiled pattern.
+     */
+    pointer get(const std::string& p)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            auto it = index.find(p);
+            if (it != index.end()) {
+                ++hit;
+                lru.splice(lru.begin(),lru,it->second);
+                return it->second->second;
+            }
+            ++miss;
+        }
+        pointer c = make(p);
+        std::lock_guard<std::mutex> lock(m);
+        auto it = index.find(p);
+        if (it != index.end()) {
+            // another thread compiled the same pattern meanwhile
+            lru.splice(lru.begin(),lru,it->second);
+            return it->second->second;
+        }
+        lru.emplace_front(p,c);
+        index.emplace(p,lru.begin());
+        if (lru.size() > capacity) {
+            index.erase(lru.back().first);
+            lru.pop_back();
+        }
+        return c;
+    }
+
+    /**
+     * @return Number of patterns in the cache.
+     */
+    size_t size() const
+    {
+        std::lock_guard<std::mutex> lock(m);
+        return lru.size();
+    }
+
+    /**
+     * @return Number of requests answered from the cache.
+     */
+    size_t hits() const
+    {
+        std::lock_guard<std::mutex> lock(m);
+        return hit;
+    }
+
+    /**
+     * @return Number of requests that compiled the pattern.
+     */
+    size_t misses() const
+    {
+        std::lock_guard<std::mutex> lock(m);
+        return miss;
+    }
+
+private:
+    typedef std::list<std::pair<std::string,pointer>> list_type;
+
+    static factory default_factory()
+    {
+        return [](const std::string& p) {
+            return std::make_shared<const compiled_type>(p);
+        };
+    }
+
+    const size_t capacity;
+    const factory make;
+    list_type lru;
+    std::unordered_map<std::string,typename list_type::iterator> index;
+    mutable std::mutex m;
+    size_t hit, miss;
+};
+
+} // rmatch
+
+#endif // PATTERN_CACHE_HPP
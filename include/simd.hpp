@@ -0,0 +1,36 @@
+/*
+ * Runtime detection of the SIMD instruction sets used by the specialized byte
+ * string code paths of the library. The vectorized functions are compiled with
+ * per-function target attributes, so the library does not require building the
+ * whole program for a specific instruction set.
+ *
+ * Copyright (c) 2015 Jarno Leppänen
+ */
+
+#ifndef SIMD_HPP
+#define SIMD_HPP
+
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define RMATCH_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace rmatch {
+namespace detail {
+
+/* Returns true, if the processor supports AVX2 instructions. */
+inline bool has_avx2()
+{
+#ifdef RMATCH_X86_SIMD
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    return avx2;
+#else
+    return false;
+#endif
+}
+
+} // detail
+} // rmatch
+
+#endif // SIMD_HPP
@@ -0,0 +1,207 @@
+/*
+ * A text read sequentially from a file in fixed size chunks. Only the current
+ * chunk and a lookback of the characters preceding it are kept in memory, so
+ * that scanning algorithms looking at a bounded window of the text can process
+ * texts that do not fit in memory.
+ *
+ * Copyright (c) 2015 Jarno Leppänen
+ */
+
+#ifndef STREAM_TEXT_HPP
+#define STREAM_TEXT_HPP
+
+#include "match_length.hpp"
+
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cstddef>
+
+namespace rmatch {
+
+/**
+ * @brief Source of text characters reading a C stdio stream.
+ *
+ * Any class with a member function size_t read(char *buf, size_t size)
+ * returning the number of characters stored into buf, or 0 at the end of the
+ * text, can be used as a source of a stream_text.
+ */
+class file_source {
+public:
+    /**
+     * @param f Stream the text is read from. The stream is not closed.
+     */
+    explicit file_source(std::FILE *f): f(f) {}
+
+    /**
+     * Read the next characters of the text.
+     *
+     * @param buf Destination buffer.
+     * @param size Maximum number of characters to read.
+     * @return Number of characters read; 0 at the end of the text or on error.
+     */
+    size_t read(char *buf, size_t size) { return std::fread(buf,1,size,f); }
+
+    /**
+     * @return True, if reading the stream has failed.
+     */
+    bool failed() const { return std::ferror(f) != 0; }
+
+private:
+    std::FILE *f;
+};
+
+/**
+ * @brief Sliding window over a text read from a source in chunks.
+ *
+ * Positions are absolute offsets from the beginning of the text. A position is
+ * made available by calling has(), which reads more chunks from the source if
+ * needed. When a chunk is read, all but the last lookback() characters of the
+ * window are discarded. Algorithms must therefore only access positions that
+ * are at most lookback() characters before the largest position given to
+ * has(), and they must declare the lookback they need before scanning with
+ * require_lookback().
+ */
+template <typename source_type>
+class stream_text {
+public:
+    /**
+     * @param src Source of the characters. (reference is kept)
+     * @param chunk Number of characters read from the source at a time.
+     */
+    explicit stream_text(source_type& src, size_t chunk = 1 << 20):
+        src(src), chunk(std::max<size_t>(chunk,1)), back(0), base(0), len(0),
+        eof(false) {}
+
+    /**
+     * Make sure that at least b characters preceding the most recently
+     * requested position stay in memory. Growing the lookback keeps more of
+     * the window but never brings back characters that were already
+     * discarded.
+     *
+     * @param b Number of characters.
+     */
+    void require_lookback(size_t b) { back = std::max(back,b); }
+
+    /**
+     * @return Number of characters kept before the most recently requested
+     * position.
+     */
+    size_t lookback() const { return back; }
+
+    /**
+     * Make position i available, if the text is longer than i characters.
+     *
+     * @param i Position in the text.
+     * @return True, if the text has a character at position i.
+     */
+    bool has(size_t i) { return i < base+len || fill(i); }
+
+    /**
+     * Retrieve the character at a position that has been made available with
+     * has() and is still within the lookback.
+     *
+     * @param i Position in the text.
+     * @return Character at position i.
+     */
+    char operator[](size_t i) const { return buf[i-base]; }
+
+    /**
+     * @param i Available position in the text.
+     * @return Pointer to the characters starting at position i.
+     */
+    const char *data(size_t i) const { return &buf[i-base]; }
+
+    /**
+     * @param i Available position in the text.
+     * @return Number of consecutive characters in memory starting at
+     * position i.
+     */
+    size_t buffered(size_t i) const { return base+len-i; }
+
+    /**
+     * Calculate the length of the longest common prefix of the suffix of the
+     * text starting at position i and a pattern, reading more of the text as
+     * needed.
+     *
+     * @param i Position in the text.
+     * @param p Pattern. (random access iterator)
+     * @param m Length of the pattern.
+     * @return Length of the longest common prefix.
+     */
+    template <typename string_type, typename size_type>
+    size_type match_length(size_t i, string_type p, size_type m)
+    {
+        size_type l = 0;
+        while (l < m && has(i+l)) {
+            const size_type a = std::min<size_type>(m-l,buffered(i+l));
+            const size_type e = detail::match_length(data(i+l),p+l,a);
+            l += e;
+            if (e < a) break;
+        }
+        return l;
+    }
+
+    /**
+     * @return Number of characters read so far. This is the length of the
+     * text once has() has returned false.
+     */
+    size_t size() const { return base+len; }
+
+private:
+    /* Read chunks until position i is in the window or the text ends. */
+    bool fill(size_t i)
+    {
+        while (!eof && i >= base+len) {
+            // keep the lookback and append a new chunk after it
+            const size_t keep = std::min(back,len);
+            if (buf.size() < keep+chunk) buf.resize(keep+chunk);
+            std::memmove(&buf[0],&buf[len-keep],keep);
+            base += len-keep;
+            len = keep;
+            const size_t r = src.read(&buf[len],chunk);
+            len += r;
+            eof = r == 0;
+        }
+        return i < base+len;
+    }
+
+    source_type& src;
+    const size_t chunk;
+    size_t back;
+    std::vector<char> buf;
+    size_t base, len;
+    bool eof;
+};
+
+namespace detail {
+
+/* Text of a given length in memory accessed through a random access iterator,
+   with the interface of stream_text used by the algorithms that run over both
+   kinds of text. */
+template <typename text_type, typename index_type>
+struct array_text {
+    text_type x;
+    index_type n;
+
+    array_text(text_type x, index_type n): x(x), n(n) {}
+
+    bool has(index_type i) const { return i < n; }
+
+    auto operator[](index_type i) const -> decltype(x[i]) { return x[i]; }
+
+    /* Length of the longest common prefix of suffix x[i..n) and p[0..m). */
+    template <typename pattern_type>
+    index_type match_length(index_type i, pattern_type p, index_type m) const
+    {
+        using rmatch::detail::match_length;
+        return match_length(x+i,p,std::min(n-i,m));
+    }
+};
+
+} // detail
+
+} // rmatch
+
+#endif // STREAM_TEXT_HPP
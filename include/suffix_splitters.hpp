@@ -0,0 +1,101 @@
+/*
+ * Suffix comparisons and splitter sampling shared by the blockwise suffix
+ * sorters, which divide the suffixes of a text into lexicographic blocks by
+ * splitter strings sampled from the text.
+ *
+ * Characters are compared as char throughout, not as the unsigned characters
+ * of std::string comparisons.
+ *
+ * Copyright (c) 2015 Jarno Leppänen
+ */
+
+#ifndef SUFFIX_SPLITTERS_HPP
+#define SUFFIX_SPLITTERS_HPP
+
+#include "match_length.hpp"
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <functional>
+#include <cstdint>
+
+namespace rmatch {
+namespace detail {
+
+/* Returns true, if suffix t[a+d..n) is smaller than suffix t[b+d..n). */
+inline bool suffix_less(const char *t, size_t n, size_t a, size_t b,
+        size_t d = 0)
+{
+    const size_t max = n - std::max(a,b) - d;
+    const size_t l = match_length(t+a+d,t+b+d,max);
+    return l == max ? a > b : t[a+d+l] < t[b+d+l];
+}
+
+/* Returns true, if suffix t[a..n) is smaller than string p. */
+inline bool suffix_less(const char *t, size_t n, size_t a,
+        const std::string& p)
+{
+    const size_t max = std::min(n-a,p.size());
+    const size_t l = match_length(t+a,p.data(),max);
+    return l < p.size() && (l == n-a || t[a+l] < p[l]);
+}
+
+/* Returns true, if string a is smaller than string b comparing characters as
+   char, like the suffixes are compared. */
+inline bool string_less(const std::string& a, const std::string& b)
+{
+    return std::lexicographical_compare(a.begin(),a.end(),b.begin(),b.end());
+}
+
+/* Function receiving the positions of a set of suffixes. */
+typedef std::function<void(uint64_t)> position_sink;
+
+/**
+ * @brief Choose splitters dividing a set of suffixes into blocks of about
+ * equal size.
+ *
+ * The splitters are prefixes of evenly spaced suffixes of the set cut to the
+ * given length, chosen from a sorted sample. Long prefixes of repetitive
+ * texts are sampled more sparsely to keep the sample within the given memory.
+ *
+ * @param t Text.
+ * @param n Size of the text.
+ * @param source Function calling its position_sink argument for the position
+ * of each suffix of the set.
+ * @param c Number of suffixes in the set.
+ * @param blocks Number of blocks to divide the set into.
+ * @param memory Number of bytes available for the sample.
+ * @param prefix Length of the splitters.
+ * @return At most blocks-1 splitters in increasing order.
+ */
+template <typename source_type>
+std::vector<std::string> sample_splitters(const char *t, size_t n,
+        const source_type& source, size_t c, size_t blocks, size_t memory,
+        size_t prefix)
+{
+    const size_t oversampling = 16;
+    const size_t samples = std::min(std::min(c,blocks*oversampling),
+            std::max(blocks,memory/prefix));
+    std::vector<std::string> sample;
+    sample.reserve(samples);
+    size_t i = 0, next = 0;
+    source(position_sink([&](uint64_t p) {
+        if (i++ == next) {
+            sample.push_back(std::string(t+p,std::min<size_t>(prefix,n-p)));
+            next = sample.size()*c/samples;
+        }
+    }));
+    std::sort(sample.begin(),sample.end(),string_less);
+    std::vector<std::string> s;
+    for (size_t b = 1; b < blocks && !sample.empty(); ++b) {
+        const std::string& p = sample[b*sample.size()/blocks];
+        if (s.empty() || string_less(s.back(),p)) s.push_back(p);
+    }
+    return s;
+}
+
+} // detail
+} // rmatch
+
+#endif // SUFFIX_SPLITTERS_HPP
@@ -0,0 +1,144 @@
+/*
+ * Algorithm selection and dispatch shared by the command line program and the
+ * benchmark suite.
+ *
+ * Copyright (c) 2015 Jarno Leppänen
+ */
+
+#ifndef METHOD_HPP
+#define METHOD_HPP
+
+#include "Crochemore.hpp"
+#include "ZAlgorithm.hpp"
+#include "SuffixArray.hpp"
+#include "gs_count.hpp"
+#include "naive_match.hpp"
+#include "kmp_match.hpp"
+#include "packed_dna.hpp"
+#include "timer.hpp"
+#include <iterator>
+#include <cstring>
+
+/* Different algorithm types. */
+enum method {
+    NAIVE,
+    GS,
+    C,
+    Z,
+    SA,
+    KMP,
+    METHOD_COUNT
+};
+
+/* Command line names of the algorithm types in enum order. */
+static const char *const method_names[METHOD_COUNT] = {
+    "n", "gs", "c", "z", "sa", "kmp"
+};
+
+/**
+ * Find the algorithm type with the given command line name.
+ *
+ * @param name Command line name of the algorithm.
+ * @param m Destination algorithm type.
+ * @return True, if an algorithm with the name was found.
+ */
+inline bool parse_method(const char *name, method& m)
+{
+    for (int i = 0; i < METHOD_COUNT; ++i) {
+        if (!strcmp(name,method_names[i])) {
+            m = static_cast<method>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Run the selected algorithm recording each of its phases separately.
+ *
+ * @param m Algorithm to run.
+ * @param t Input text. (random access container)
+ * @param b Lower bound pattern. (random access container)
+ * @param e Upper bound pattern. (random access container)
+ * @param k Constant k of the Galil-Seiferas count.
+ * @param out Destination container for the matching positions. Positions
+ * are not stored if m is GS.
+ * @param prof Profiler the phases are recorded to.
+ * @param ordered If true, the suffix array search stores the positions in
+ * text order like the other algorithms instead of suffix order.
+ * @return Number of matching suffixes.
+ */
+template <typename string_type, typename output_container>
+size_t run_method(method m,
+        const string_type& t, const string_type& b, const string_type& e,
+        size_t k, output_container& out, profiler& prof, bool ordered = false)
+{
+    switch (m) {
+        case NAIVE: {
+            profiler::phase p(prof,"search");
+            rmatch::naive_match_range(t,b,e,std::back_inserter(out));
+            break;
+        }
+        case GS: {
+            size_t l, u;
+            {
+                profiler::phase p(prof,"lower bound");
+                l = rmatch::gs_count_less(t.begin(),t.size(),
+                        b.begin(),b.size(),k);
+            }
+            {
+                profiler::phase p(prof,"upper bound");
+                u = rmatch::gs_count_less(t.begin(),t.size(),
+                        e.begin(),e.size(),k);
+            }
+            return u < l ? 0 : u - l;
+        }
+        case C: {
+            profiler::phase lp(prof,"lower bound");
+            boost::dynamic_bitset<> l = rmatch::lowerBound(t,b);
+            lp.stop();
+            profiler::phase up(prof,"upper bound");
+            boost::dynamic_bitset<> u = rmatch::lowerBound(t,e);
+            up.stop();
+            profiler::phase ep(prof,"extract");
+            rmatch::retrieveRangeIndices(l,u,out);
+            break;
+        }
+        case Z: {
+            profiler::phase lp(prof,"lower bound");
+            boost::dynamic_bitset<> l = rmatch::lowerBoundZ(t,b);
+            lp.stop();
+            profiler::phase up(prof,"upper bound");
+            boost::dynamic_bitset<> u = rmatch::lowerBoundZ(t,e);
+            up.stop();
+            profiler::phase ep(prof,"extract");
+            rmatch::retrieveRangeIndices(l,u,out);
+            break;
+        }
+        case SA: {
+            profiler::phase cp(prof,"sa construction");
+            rmatch::SuffixArray<string_type> sa(t,false);
+            cp.stop();
+            profiler::phase ip(prof,"inverse sa build");
+            sa.buildInv();
+            ip.stop();
+            profiler::phase lp(prof,"lcp build");
+            sa.buildLcp();
+            lp.stop();
+            profiler::phase sp(prof,"bound search");
+            if (ordered) sa.sortedRangeQuery(b,e,out);
+            else sa.rangeQuery(b,e,out);
+            break;
+        }
+        case KMP: {
+            profiler::phase p(prof,"search");
+            rmatch::kmp_match_range(t,b,e,std::back_inserter(out));
+            break;
+        }
+        default:
+            break;
+    }
+    return out.size();
+}
+
+#endif
@@ -0,0 +1,199 @@
+/*
+ * Cost model implementation for automatic algorithm selection
+ *
+ * Copyright (c) 2015 Jarno Leppänen
+ */
+
+#include "plan.hpp"
+#include "Util.hpp"
+#include <vector>
+#include <random>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+using namespace std;
+
+/* Key of the suffix array query constant in the cost file. */
+static const char *sa_query_key = "sa_query";
+
+cost_model::cost_model(): sa_query_ns(5)
+{
+    // rough defaults used until the constants are calibrated
+    static const double defaults[METHOD_COUNT] = { 10, 18, 20, 20, 80, 18 };
+    for (int i = 0; i < METHOD_COUNT; ++i) ns_per_char[i] = defaults[i];
+}
+
+double estimate_bytes(method m, size_t n, size_t pm)
+{
+    switch (m) {
+        case NAIVE: return 0;
+        case GS:    return 2*sizeof(size_t)*3*(log2(pm+1.0)+1);
+        case C:     return n/4.0;
+        case Z:     return (n+pm)*(1.0+sizeof(size_t))+n/4.0;
+        case SA:    return n*(1.0+3*sizeof(int));
+        case KMP:   return 2.0*sizeof(ptrdiff_t)*pm;
+        default:    return 0;
+    }
+}
+
+double estimate_seconds(const cost_model& costs, method m, size_t n,
+        size_t pm)
+{
+    double t = costs.ns_per_char[m]*n;
+    if (m == SA) t += costs.sa_query_ns*max<size_t>(pm,1)*log2(n+2.0);
+    return t*1e-9;
+}
+
+plan choose_method(const cost_model& costs, size_t n, size_t pm,
+        bool count_only, double memory)
+{
+    plan p;
+    p.m = KMP;
+    p.seconds = numeric_limits<double>::max();
+    p.bytes = numeric_limits<double>::max();
+    bool found = false;
+    double least = numeric_limits<double>::max();
+    method smallest = GS;
+    for (int i = 0; i < METHOD_COUNT; ++i) {
+        method m = static_cast<method>(i);
+        p.estimates[i] = estimate_seconds(costs,m,n,pm);
+        p.feasible[i] = false;
+        if (m == GS && !count_only) continue;
+        if (m == NAIVE && pm > naive_max_pattern) continue;
+        double bytes = estimate_bytes(m,n,pm);
+        if (bytes < least) {
+            least = bytes;
+            smallest = m;
+        }
+        if (bytes > memory) continue;
+        p.feasible[i] = true;
+        if (p.estimates[i] < p.seconds) {
+            p.m = m;
+            p.seconds = p.estimates[i];
+            p.bytes = bytes;
+            found = true;
+        }
+    }
+    if (!found) {
+        p.m = smallest;
+        p.seconds = p.estimates[smallest];
+        p.bytes = least;
+    }
+    return p;
+}
+
+void print_plan(FILE *f, const plan& p)
+{
+    fprintf(f,"chose method \"%s\": estimated %.6f s, %.0f bytes of extra "
+            "memory\n",method_names[p.m],p.seconds,p.bytes);
+    for (int i = 0; i < METHOD_COUNT; ++i) {
+        fprintf(f,"  %-4s %.6f s%s\n",method_names[i],p.estimates[i],
+                p.feasible[i] ? "" : " (not applicable)");
+    }
+}
+
+cost_model calibrate()
+{
+    const size_t n = 1<<20, pm = 8, queries = 1000;
+    // the calibration text is the same with every standard library
+    mt19937_64 rng(1);
+    auto pos = [&]() { return rmatch::uniformBelow(rng,n-pm+1); };
+    string t(n,0);
+    for (size_t i = 0; i < n; ++i) t[i] = 'a' + rmatch::uniformBelow(rng,16);
+    string b = t.substr(pos(),pm);
+    string e = t.substr(pos(),pm);
+    if (e < b) b.swap(e);
+
+    cost_model costs;
+    for (int i = 0; i < METHOD_COUNT; ++i) {
+        method m = static_cast<method>(i);
+        double best = numeric_limits<double>::max();
+        for (int r = 0; r < 3; ++r) {
+            vector<size_t> out;
+            profiler prof(false);
+            run_method(m,t,b,e,3,out,prof);
+            double span = prof.total().span;
+            // only the construction of the suffix array scales with n
+            for (auto& ph: prof.phases()) {
+                if (m == SA && !strcmp(ph.name,"bound search")) {
+                    span -= ph.span;
+                }
+            }
+            best = min(best,span);
+        }
+        costs.ns_per_char[m] = best*1e9/n;
+    }
+
+    // queries for the suffixes prefixed by a substring measure the binary
+    // search alone without the cost of copying a large output interval
+    rmatch::SuffixArray<string> sa(t,false);
+    vector<string> lower(queries), upper(queries);
+    for (size_t q = 0; q < queries; ++q) {
+        lower[q] = upper[q] = t.substr(pos(),pm);
+        ++upper[q].back();
+    }
+    timer tm(false);
+    for (size_t q = 0; q < queries; ++q) {
+        vector<size_t> out;
+        sa.rangeQuery(lower[q],upper[q],out);
+    }
+    costs.sa_query_ns = tm.seconds()*1e9/(queries*pm*log2(n+2.0));
+    return costs;
+}
+
+bool load_costs(const string& path, cost_model& costs)
+{
+    FILE *f = fopen(path.c_str(),"r");
+    if (!f) return false;
+    cost_model c;
+    int found = 0;
+    char key[32];
+    double value;
+    while (fscanf(f," %31s %lf",key,&value) == 2) {
+        method m;
+        if (parse_method(key,m)) {
+            c.ns_per_char[m] = value;
+            ++found;
+        } else if (!strcmp(key,sa_query_key)) {
+            c.sa_query_ns = value;
+            ++found;
+        }
+    }
+    fclose(f);
+    if (found != METHOD_COUNT+1) return false;
+    costs = c;
+    return true;
+}
+
+bool save_costs(const string& path, const cost_model& costs)
+{
+    FILE *f = fopen(path.c_str(),"w");
+    if (!f) return false;
+    for (int i = 0; i < METHOD_COUNT; ++i) {
+        fprintf(f,"%s %f\n",method_names[i],costs.ns_per_char[i]);
+    }
+    fprintf(f,"%s %f\n",sa_query_key,costs.sa_query_ns);
+    return fclose(f) == 0;
+}
+
+string costs_path()
+{
+    const char *p = getenv("RMATCH_COSTS");
+    if (p && *p) return p;
+    const char *home = getenv("HOME");
+    return string(home ? home : ".") + "/.rmatch_costs";
+}
+
+double available_memory()
+{
+#ifdef _SC_AVPHYS_PAGES
+    long pages = sysconf(_SC_AVPHYS_PAGES);
+    long size = sysconf(_SC_PAGESIZE);
+    if (pages > 0 && size > 0) return double(pages)*size;
+#endif
+    return numeric_limits<double>::max();
+}
@@ -0,0 +1,128 @@
+/*
+ * A cost model for choosing the string range matching algorithm automatically
+ * based on the input size, the kind of output needed and the available
+ * memory.
+ *
+ * Copyright (c) 2015 Jarno Leppänen
+ */
+
+#ifndef PLAN_HPP
+#define PLAN_HPP
+
+#include "method.hpp"
+#include <string>
+#include <cstdio>
+
+/**
+ * Calibrated cost constants of the algorithms. Scanning algorithms cost a
+ * constant time per text character for each query. The suffix array costs
+ * a construction time per text character once and a binary search time per
+ * query character scaled by log2 of the text size.
+ */
+struct cost_model {
+    /* Time per text character of a single query in nanoseconds. For SA this
+       is the construction time. */
+    double ns_per_char[METHOD_COUNT];
+    /* Time of a suffix array query per pattern character and log2(n) in
+       nanoseconds. */
+    double sa_query_ns;
+    cost_model();
+};
+
+/* The chosen algorithm and its estimated costs. */
+struct plan {
+    method m;
+    double seconds;
+    double bytes;
+    double estimates[METHOD_COUNT];
+    bool feasible[METHOD_COUNT];
+};
+
+/* Patterns longer than this are not considered for naive search as its worst
+   case time is O(nm) while the calibration only sees short random matches. */
+const size_t naive_max_pattern = 64;
+
+/**
+ * Estimate the extra memory an algorithm needs excluding input and output.
+ *
+ * @param m Algorithm.
+ * @param n Length of the text.
+ * @param pm Length of the longer bound pattern.
+ * @return Estimated extra memory in bytes.
+ */
+double estimate_bytes(method m, size_t n, size_t pm);
+
+/**
+ * Estimate the running time of a single range query with an algorithm,
+ * including the construction of the suffix array.
+ *
+ * @param costs Calibrated cost constants.
+ * @param m Algorithm.
+ * @param n Length of the text.
+ * @param pm Length of the longer bound pattern.
+ * @return Estimated running time in seconds.
+ */
+double estimate_seconds(const cost_model& costs, method m, size_t n,
+        size_t pm);
+
+/**
+ * Choose the fastest algorithm for a single range query that fits into the
+ * available memory. If no algorithm fits, the one using the least memory is
+ * chosen.
+ *
+ * @param costs Calibrated cost constants.
+ * @param n Length of the text.
+ * @param pm Length of the longer bound pattern.
+ * @param count_only True, if only the number of matching suffixes is needed.
+ * @param memory Available memory in bytes.
+ * @return The chosen plan.
+ */
+plan choose_method(const cost_model& costs, size_t n, size_t pm,
+        bool count_only, double memory);
+
+/**
+ * Print a plan and the estimates of all algorithms in human readable form.
+ *
+ * @param f Destination file.
+ * @param p Printed plan.
+ */
+void print_plan(FILE *f, const plan& p);
+
+/**
+ * Calibrate the cost constants by running every algorithm on a locally
+ * generated random text.
+ *
+ * @return Calibrated cost constants.
+ */
+cost_model calibrate();
+
+/**
+ * Load cost constants from a file.
+ *
+ * @param path Path of the file.
+ * @param costs Destination cost constants.
+ * @return True, if the file was read successfully.
+ */
+bool load_costs(const std::string& path, cost_model& costs);
+
+/**
+ * Save cost constants to a file.
+ *
+ * @param path Path of the file.
+ * @param costs Saved cost constants.
+ * @return True, if the file was written successfully.
+ */
+bool save_costs(const std::string& path, const cost_model& costs);
+
+/**
+ * @return Path of the cost constant file: $RMATCH_COSTS if it is set,
+ * otherwise $HOME/.rmatch_costs.
+ */
+std::string costs_path();
+
+/**
+ * @return Available physical memory in bytes.
+ */
+double available_memory();
+
+#endif
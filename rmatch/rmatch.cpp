@@ -5,26 +5,35 @@
  * Copyright (c) 2015 Jarno Leppänen
  */
 
-#include "Crochemore.hpp"
-#include "ZAlgorithm.hpp"
-#include "SuffixArray.hpp"
-#include "gs_count.hpp"
-#include "naive_match.hpp"
-#include "kmp_match.hpp"
+#include "method.hpp"
+#include "plan.hpp"
 #include "mallocate.hpp"
 #include "timer.hpp"
+#include "stream_text.hpp"
+#include "async_reader.hpp"
+#include "packed_dna.hpp"
+#include "bwt.hpp"
+#include "GeneralizedSuffixArray.hpp"
 #include <string>
+#include <vector>
+#include <memory>
 #include <fstream>
+#include <iostream>
 #include <limits>
 #include <chrono>
 #include <cstdlib>
 #include <cstring>
 #include <cstdarg>
+#include <cstdint>
+#include <cerrno>
+#include <thread>
 #include <getopt.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 using namespace std;
 
-const char *shopts = "hm:k:sf:t:c:p";
+const char *shopts = "hm:k:sf:t:c:pnCSw:lW:O";
 
 const option opts[] = {
     { "help",   no_argument,       nullptr, 'h' },
@@ -35,6 +44,13 @@ const option opts[] = {
     { "test",   required_argument, nullptr, 't' },
     { "cut",    required_argument, nullptr, 'c' },
     { "time",   no_argument,       nullptr, 'p' },
+    { "count",  no_argument,       nullptr, 'n' },
+    { "calibrate", no_argument,    nullptr, 'C' },
+    { "stream", no_argument,       nullptr, 'S' },
+    { "width",  required_argument, nullptr, 'w' },
+    { "list",   no_argument,       nullptr, 'l' },
+    { "window", required_argument, nullptr, 'W' },
+    { "ordered", no_argument,      nullptr, 'O' },
     { nullptr,  no_argument,       nullptr,  0  }
 };
 
@@ -44,24 +60,67 @@ Mandatory arguments to long options are mandatory for short options too.
   -m, --method=METHOD  set the matching algorithm; possible values are "n"
                          (naive O(nm) search), "gs" (Galil-Seiferas count), "c"
                          (Crochemore), "z" (Z-algorithm), "sa" (suffix array
-                         search) or "kmp" (Knuth-Morris-Pratt); default is "n"
+                         search), "kmp" (Knuth-Morris-Pratt) or "auto"
+                         (choose the fastest algorithm that fits into the
+                         available memory using calibrated cost estimates
+                         and print the plan to stderr); default is "n"
   -k, --k=VALUE        run range match count k set to VALUE, only has effect if
                          METHOD is "gs"; k must be larger or equal to 3,
                          default is 3
   -s, --silent         do not produce any output; if -p is set, timing output
                        will still be printed
-  -f, --file=FILE      load text from file FILE
+  -f, --file=FILE      load text from file FILE; if the text and the patterns
+                         consist of bases A, C, G and T only, the text is
+                         packed into two bits per base; -f can be given
+                         several times to index the files together as a
+                         collection of documents, in which case matches are
+                         printed as the file and the offset in the file
   -t, --test=TESTFILE  load test file from file TESTFILE
   -c, --cut=CHARS      use first CHARS characters of the source text and ignore
                        the rest
-  -p, --time           print timing output in seconds
+  -n, --count          only print the number of matching suffixes, or the
+                         number in each file if -f is given several times
+  -l, --list           only print the files having matching suffixes; the
+                         files are indexed as a collection of documents
+  -S, --stream         read the text of FILE in chunks instead of loading it
+                         into memory, and print matching positions as soon as
+                         they are found; a reader thread reads ahead while
+                         the text is matched; FILE may be "-" for standard
+                         input, METHOD must be "gs", "kmp" or "auto" and -c
+                         has no effect
+  -w, --width=BITS     read FILE as a binary array of unsigned BITS-bit integer
+                         symbols in native byte order, where BITS is 8, 16 or
+                         32, and give BEGIN and END as comma-separated lists
+                         of symbol values; -c counts symbols
+  -W, --window=FROM,TO only match the suffixes starting at the positions
+                         [FROM,TO) of the text, which are found and printed
+                         in text order with a wavelet tree of the suffix
+                         array, so -O has no further effect; METHOD must be
+                         "sa" or "auto", which always uses "sa" without a
+                         plan
+  -O, --ordered        print the positions found by METHOD "sa" in text order
+                         like the other methods instead of suffix order;
+                         dense results are sorted with a bit vector of the
+                         text and sparse ones with radix sort
+  -C, --calibrate      measure the cost constants used by the "auto" method
+                         and save them to $RMATCH_COSTS or ~/.rmatch_costs;
+                         "auto" calibrates once automatically if the file
+                         does not exist
+  -p, --time           print wall time in seconds and hardware performance
+                       counters (cycles, instructions, cache misses and branch
+                       misses) of the whole run and of each of its phases as
+                       JSON; counters are null if they are not available and
+                       cover the main thread only, not the worker threads
+                       of parallel methods, which show in the time only
 )STR";
 
 void usage(FILE *f, const char *app)
 {
     fprintf(f, "Usage: %s [OPTION] TEXT BEGIN END     (1st form)\n", app);
     fprintf(f, " or:   %s [OPTION] -f FILE BEGIN END  (2nd form)\n", app);
+    fprintf(f, " or:   %s [OPTION] -f FILE -f FILE... BEGIN END\n", app);
     fprintf(f, " or:   %s [OPTION] -t TESTFILE        (3rd form)\n", app);
+    fprintf(f, " or:   %s bwt [OPTION] FILE           (transform)\n", app);
 }
 
 void help(FILE *f, const char *app)
@@ -93,16 +152,6 @@ bool readfile(const char *file, string_type& s, size_t c)
 }
 
 
-/* Different algorithm types. */
-enum method {
-    NAIVE,
-    GS,
-    C,
-    Z,
-    SA,
-    KMP
-};
-
 /* The default string type for input using a custom allocator that allows
    ignoring input text allocations. */
 typedef basic_string<char,char_traits<char>,mallocator<char>> mstring;
@@ -113,14 +162,26 @@ struct input {
     mstring b;
     mstring e;
     method m;
+    bool a;
     size_t k;
     int s;
     size_t c;
     bool p;
+    bool n;
+    bool stream;
+    int w;
+    bool l;
+    bool win;
+    bool o;
+    size_t wa;
+    size_t wb;
+    string f;
+    vector<string> fs;
     int ret;
     input():
-        k(3), m(NAIVE), s(false), ret(0), p(false),
-        c(numeric_limits<size_t>::max()) {}
+        m(NAIVE), a(false), k(3), s(false), c(numeric_limits<size_t>::max()),
+        p(false), n(false), stream(false), w(0), l(false), win(false),
+        o(false), wa(0), wb(0), ret(0) {}
 };
 
 bool readtestfile(const char *file, input& in)
@@ -143,12 +204,27 @@ bool fail(input& in)
     return false;
 }
 
+/* Parse a window of text positions given as FROM,TO. */
+bool parse_window(const char *s, size_t& a, size_t& b)
+{
+    char *end;
+    errno = 0;
+    if (*s == '-') return false;
+    a = strtoull(s,&end,10);
+    if (end == s || *end != ',' || errno) return false;
+    s = end+1;
+    if (*s == '-') return false;
+    b = strtoull(s,&end,10);
+    return end != s && !*end && !errno;
+}
+
 /* Read input data from command line arguments and input files. */
 bool init(int argc, char *const argv[], input& in)
 {
     char c;
     const char *app = argv[0];
     int form = 1;
+    bool calibrating = false;
     mstring src;
     while ((c = getopt_long(argc, argv, shopts, opts, nullptr)) != -1) {
         switch (c) {
@@ -156,19 +232,8 @@ bool init(int argc, char *const argv[], input& in)
                 help(stdout, app);
                 return false;
             case 'm':
-                if (!strcmp(optarg,"n")) {
-                    in.m = NAIVE;
-                } else if (!strcmp(optarg,"gs")) {
-                    in.m = GS;
-                } else if (!strcmp(optarg,"c")) {
-                    in.m = C;
-                } else if (!strcmp(optarg,"z")) {
-                    in.m = Z;
-                } else if (!strcmp(optarg,"sa")) {
-                    in.m = SA;
-                } else if (!strcmp(optarg,"kmp")) {
-                    in.m = KMP;
-                } else {
+                in.a = !strcmp(optarg,"auto");
+                if (!in.a && !parse_method(optarg,in.m)) {
                     nag(app,"unknown method \"%s\"\n",optarg);
                     return fail(in);
                 }
@@ -186,6 +251,7 @@ bool init(int argc, char *const argv[], input& in)
             case 'f':
                 form = 2;
                 src = optarg;
+                in.fs.push_back(optarg);
                 break;
             case 't':
                 form = 3;
@@ -201,12 +267,100 @@ bool init(int argc, char *const argv[], input& in)
             case 'p':
                 in.p = true;
                 break;
+            case 'n':
+                in.n = true;
+                break;
+            case 'S':
+                in.stream = true;
+                break;
+            case 'w':
+                in.w = atoi(optarg);
+                if (in.w != 8 && in.w != 16 && in.w != 32) {
+                    nag(app,"BITS must be 8, 16 or 32\n");
+                    return fail(in);
+                }
+                break;
+            case 'l':
+                in.l = true;
+                break;
+            case 'W':
+                if (!parse_window(optarg,in.wa,in.wb)) {
+                    nag(app,"window must be FROM,TO\n");
+                    return fail(in);
+                }
+                in.win = true;
+                break;
+            case 'O':
+                in.o = true;
+                break;
+            case 'C':
+                calibrating = true;
+                break;
             case '?':
             default:
                 // getopt prints errors
                 return fail(in);
         }
     }
+    if (calibrating) {
+        if (!save_costs(costs_path(),calibrate())) {
+            nag(app,"can't write cost file %s\n",costs_path().c_str());
+            return fail(in);
+        }
+        // calibrating alone is a valid invocation
+        if (form == 1 && optind == argc) return false;
+    }
+    if (in.win) {
+        if (in.w || in.stream || in.fs.size() > 1 || in.l) {
+            nag(app,"--window can't be used with --width, --stream, --list "
+                    "or several files\n");
+            return fail(in);
+        }
+        if (in.a) {
+            in.a = false;
+            in.m = SA;
+        }
+        if (in.m != SA) {
+            nag(app,"--window supports only method \"sa\"\n");
+            return fail(in);
+        }
+    }
+    if (in.fs.size() > 1 || in.l) {
+        if (in.w || in.stream || form != 2 || optind+2 > argc) {
+            nag(app,"several files and --list expect -f FILE and BEGIN and "
+                    "END patterns without --width or --stream\n");
+            return fail(in);
+        }
+        in.b = argv[optind];
+        in.e = argv[optind+1];
+        return true;
+    }
+    if (in.w) {
+        if (in.stream || form != 2 || optind+2 > argc) {
+            nag(app,"--width expects -f FILE and BEGIN and END patterns "
+                    "without --stream\n");
+            return fail(in);
+        }
+        in.f = src.c_str();
+        in.b = argv[optind];
+        in.e = argv[optind+1];
+        return true;
+    }
+    if (in.stream) {
+        if (form != 2 || optind+2 > argc) {
+            nag(app,"--stream expects -f FILE and BEGIN and END patterns\n");
+            return fail(in);
+        }
+        if (in.a) in.m = in.n ? GS : KMP;
+        if (in.m != GS && in.m != KMP) {
+            nag(app,"--stream supports only methods \"gs\" and \"kmp\"\n");
+            return fail(in);
+        }
+        in.f = src.c_str();
+        in.b = argv[optind];
+        in.e = argv[optind+1];
+        return true;
+    }
     switch (form) {
         case 1:
             if (optind+3 > argc) {
@@ -228,6 +382,7 @@ bool init(int argc, char *const argv[], input& in)
                 nag(app,"can't read file %s\n",src.c_str());
                 return fail(in);
             }
+            in.f = src.c_str();
             in.b = argv[optind];
             in.e = argv[optind+1];
             break;
@@ -242,38 +397,383 @@ bool init(int argc, char *const argv[], input& in)
     return true;
 }
 
+/* Choose the algorithm with the cost model, calibrating the cost constants
+   first if they haven't been saved yet. */
+void choose(const char *app, size_t n, size_t m, input& in)
+{
+    cost_model costs;
+    const string path = costs_path();
+    if (!load_costs(path,costs)) {
+        nag(app,"calibrating cost constants to %s\n",path.c_str());
+        costs = calibrate();
+        if (!save_costs(path,costs)) {
+            nag(app,"can't write cost file %s\n",path.c_str());
+        }
+    }
+    plan p = choose_method(costs,n,m,in.n,available_memory());
+    fprintf(stderr,"%s: ",app);
+    print_plan(stderr,p);
+    in.m = p.m;
+}
+
+/* Output iterator printing matching positions as they are found and counting
+   them. */
+class position_printer:
+    public iterator<output_iterator_tag,void,void,void,void> {
+public:
+    position_printer(bool print, size_t& count): print(print), count(&count) {}
+    position_printer& operator=(size_t v)
+    {
+        ++*count;
+        if (print) printf("%ld\n",v);
+        return *this;
+    }
+    position_printer& operator*() { return *this; }
+    position_printer& operator++() { return *this; }
+    position_printer& operator++(int) { return *this; }
+private:
+    bool print;
+    size_t *count;
+};
+
+/* Match a text streamed from a file or standard input in bounded memory. A
+   reader thread reads the file ahead of the matchers. The two bounds of the
+   Galil-Seiferas count are counted in threads of their own. */
+int stream(const char *app, const input& in)
+{
+    typedef rmatch::stream_text<rmatch::async_reader::consumer> text;
+    const bool std_in = in.f == "-";
+    const int fd = std_in ? STDIN_FILENO : open(in.f.c_str(),O_RDONLY);
+    if (fd < 0) {
+        nag(app,"can't read file %s\n",in.f.c_str());
+        return 1;
+    }
+    bool failed;
+    profiler prof(in.p);
+    size_t c = 0;
+    {
+        profiler::phase p(prof,"search");
+        if (in.m == GS) {
+            rmatch::async_reader r(fd,2);
+            size_t l = 0, u = 0;
+            thread lower([&]() {
+                text t(r.get(1));
+                l = rmatch::gs_count_less(t,in.b.begin(),in.b.size(),in.k);
+            });
+            text t(r.get(0));
+            u = rmatch::gs_count_less(t,in.e.begin(),in.e.size(),in.k);
+            lower.join();
+            c = u < l ? 0 : u - l;
+            failed = r.failed();
+        } else {
+            rmatch::async_reader r(fd);
+            text t(r.get(0));
+            rmatch::kmp_match_range(t,in.b.begin(),in.b.size(),
+                    in.e.begin(),in.e.size(),
+                    position_printer(!in.s && !in.n,c));
+            failed = r.failed();
+        }
+    }
+    if (!std_in) close(fd);
+    if (failed) {
+        nag(app,"error reading file %s\n",in.f.c_str());
+        return 1;
+    }
+    if (!in.s && (in.n || in.m == GS)) printf("%ld\n",c);
+    return 0;
+}
+
+/* Parse a comma-separated list of symbol values into a pattern. */
+template <typename string_type>
+bool parse_symbols(const mstring& s, string_type& p)
+{
+    typedef typename string_type::value_type symbol_type;
+    p.clear();
+    for (const char *c = s.c_str(); *c; ) {
+        char *end;
+        errno = 0;
+        const unsigned long long v = strtoull(c,&end,10);
+        if (end == c || errno || *c == '-' ||
+                v > numeric_limits<symbol_type>::max()) return false;
+        p.push_back(v);
+        c = end;
+        if (*c == ',' && c[1]) ++c;
+        else if (*c) return false;
+    }
+    return true;
+}
+
+/* Match a text of integer symbols read from a binary file. */
+template <typename symbol_type>
+int symbols(const char *app, input& in)
+{
+    typedef vector<symbol_type,mallocator<symbol_type>> text;
+    text t, b, e;
+    if (!parse_symbols(in.b,b) || !parse_symbols(in.e,e)) {
+        nag(app,"patterns must be lists of %d-bit symbol values\n",in.w);
+        return 1;
+    }
+    {
+        ifstream f(in.f.c_str(),ios::binary);
+        if (!f.good()) {
+            nag(app,"can't read file %s\n",in.f.c_str());
+            return 1;
+        }
+        f.seekg(0,ios::end);
+        t.resize(min<size_t>(f.tellg()/sizeof(symbol_type),in.c));
+        f.seekg(0);
+        f.read(reinterpret_cast<char*>(t.data()),t.size()*sizeof(symbol_type));
+    }
+    vector<size_t,mallocator<size_t>> out;
+    profiler prof(in.p);
+    if (in.a) {
+        profiler::phase p(prof,"plan");
+        choose(app,t.size(),max(b.size(),e.size()),in);
+    }
+    size_t c = run_method(in.m,t,b,e,in.k,out,prof,in.o);
+
+    profiler::phase p(prof,"output");
+    if (!in.s && !in.n && in.m != GS) for (auto v: out) printf("%ld\n",v);
+    if (!in.s && (in.n || in.m == GS)) printf("%ld\n",c);
+    return 0;
+}
+
+/* Match a text of nucleotides packed into two bits per base. The text is
+   packed right after loading and its bytes are released. */
+int bases(const char *app, input& in)
+{
+    typedef rmatch::basic_packed_dna<mallocator<uint64_t>> text;
+    vector<size_t,mallocator<size_t>> out;
+    profiler prof(in.p);
+    text t, b(in.b), e(in.e);
+    {
+        profiler::phase p(prof,"pack");
+        t.insert(t.end(),in.t.begin(),in.t.end());
+        t.shrink_to_fit();
+        mstring().swap(in.t);
+    }
+    if (in.a) {
+        profiler::phase p(prof,"plan");
+        choose(app,t.size(),max(b.size(),e.size()),in);
+    }
+    size_t c = run_method(in.m,t,b,e,in.k,out,prof,in.o);
+
+    profiler::phase p(prof,"output");
+    if (!in.s && !in.n && in.m != GS) for (auto v: out) printf("%ld\n",v);
+    if (!in.s && (in.n || in.m == GS)) printf("%ld\n",c);
+    return 0;
+}
+
+/* Match the files as a collection of documents with a generalized suffix
+   array, which reports the file of each match without searching the files
+   one by one. */
+int documents(const char *app, input& in)
+{
+    typedef rmatch::GeneralizedSuffixArray<mstring> index;
+    vector<mstring> docs(in.fs.size());
+    for (size_t d = 0; d < docs.size(); ++d) {
+        if (!readfile(in.fs[d].c_str(),docs[d],in.c)) {
+            nag(app,"can't read file %s\n",in.fs[d].c_str());
+            return 1;
+        }
+    }
+    profiler prof(in.p);
+    unique_ptr<index> sa;
+    {
+        profiler::phase p(prof,"build");
+        sa.reset(new index(docs));
+        vector<mstring>().swap(docs);
+    }
+    vector<rmatch::DocumentPosition> out;
+    vector<pair<size_t,size_t>> counts;
+    vector<size_t> found;
+    {
+        profiler::phase p(prof,"search");
+        if (in.l) found = sa->distinctDocuments(in.b,in.e);
+        else if (in.n) counts = sa->documentCounts(in.b,in.e);
+        else sa->rangeQuery(in.b,in.e,out);
+    }
+
+    profiler::phase p(prof,"output");
+    if (in.s) return 0;
+    for (size_t d: found) printf("%s\n",in.fs[d].c_str());
+    for (auto c: counts) printf("%s\t%ld\n",in.fs[c.first].c_str(),c.second);
+    for (auto v: out) printf("%s\t%ld\n",in.fs[v.doc].c_str(),v.offset);
+    return 0;
+}
+
+/* Match the suffixes starting in a window of the text with the suffix
+   array and the wavelet tree of its positions, which finds them in text
+   order without visiting the other matches. */
+int window(const char *app, input& in)
+{
+    if (in.wa > in.wb) {
+        nag(app,"window FROM must not be larger than TO\n");
+        return 1;
+    }
+    vector<size_t,mallocator<size_t>> out;
+    profiler prof(in.p);
+    profiler::phase cp(prof,"sa construction");
+    rmatch::SuffixArray<mstring> sa(in.t,false);
+    cp.stop();
+    profiler::phase wp(prof,"wavelet build");
+    sa.buildWavelet();
+    wp.stop();
+    size_t c = 0;
+    {
+        profiler::phase p(prof,"window search");
+        if (in.n) c = sa.windowCount(in.b,in.e,in.wa,in.wb);
+        else sa.windowQuery(in.b,in.e,in.wa,in.wb,out);
+    }
+
+    profiler::phase p(prof,"output");
+    if (!in.s && !in.n) for (auto v: out) printf("%ld\n",v);
+    if (!in.s && in.n) printf("%ld\n",c);
+    return 0;
+}
+
+/* True, if the text and the patterns consist of bases A, C, G and T only. */
+bool packable(const input& in)
+{
+    typedef rmatch::packed_dna dna;
+    return !in.t.empty() &&
+        dna::packable(in.t.begin(),in.t.end()) &&
+        dna::packable(in.b.begin(),in.b.end()) &&
+        dna::packable(in.e.begin(),in.e.end());
+}
+
+const char *bwt_shopts = "hM:o:p";
+
+const option bwt_opts[] = {
+    { "help",   no_argument,       nullptr, 'h' },
+    { "memory", required_argument, nullptr, 'M' },
+    { "output", required_argument, nullptr, 'o' },
+    { "time",   no_argument,       nullptr, 'p' },
+    { nullptr,  no_argument,       nullptr,  0  }
+};
+
+const char *bwt_help_str = R"STR(
+Write the Burrows-Wheeler transform of the text of FILE followed by an end
+marker. The suffixes are sorted in blocks that are gathered with range
+matching, so that the memory use is the text and one block of suffixes. The
+transform is written without the end marker, whose index is printed to
+standard error.
+  -h, --help           display this help and exit
+  -M, --memory=BYTES   memory available for a block of suffixes; BYTES may
+                         end in K, M or G; default is 256M
+  -o, --output=OUT     write the transform to OUT instead of standard output
+  -p, --time           print wall time in seconds and hardware performance
+                       counters as JSON
+)STR";
+
+/* Parse a number of bytes with an optional K, M or G suffix. */
+bool parse_bytes(const char *s, size_t& v)
+{
+    char *end;
+    errno = 0;
+    const unsigned long long x = strtoull(s,&end,10);
+    if (end == s || errno || *s == '-') return false;
+    size_t shift = 0;
+    switch (*end) {
+        case 'K': shift = 10; ++end; break;
+        case 'M': shift = 20; ++end; break;
+        case 'G': shift = 30; ++end; break;
+        default: break;
+    }
+    if (*end || x > (SIZE_MAX >> shift)) return false;
+    v = size_t(x) << shift;
+    return true;
+}
+
+/* The "bwt" command. */
+int bwt(const char *app, int argc, char *const argv[])
+{
+    char c;
+    size_t memory = size_t(256) << 20;
+    const char *output = nullptr;
+    bool time = false;
+    while ((c = getopt_long(argc, argv, bwt_shopts, bwt_opts, nullptr)) != -1) {
+        switch (c) {
+            case 'h':
+                fprintf(stdout, "Usage: %s bwt [OPTION] FILE\n", app);
+                fprintf(stdout, "%s", bwt_help_str);
+                return 0;
+            case 'M':
+                if (!parse_bytes(optarg,memory) || memory == 0) {
+                    nag(app,"BYTES must be a positive integer\n");
+                    return 1;
+                }
+                break;
+            case 'o':
+                output = optarg;
+                break;
+            case 'p':
+                time = true;
+                break;
+            case '?':
+            default:
+                return 1;
+        }
+    }
+    if (optind+1 != argc) {
+        fprintf(stderr, "Usage: %s bwt [OPTION] FILE\n", app);
+        return 1;
+    }
+    mstring t;
+    if (!readfile(argv[optind],t,numeric_limits<size_t>::max())) {
+        nag(app,"can't read file %s\n",argv[optind]);
+        return 1;
+    }
+    ofstream f;
+    if (output) {
+        f.open(output,ios::binary);
+        if (!f.good()) {
+            nag(app,"can't write file %s\n",output);
+            return 1;
+        }
+    }
+    streambuf *out = output ? f.rdbuf() : cout.rdbuf();
+    size_t primary;
+    profiler prof(time);
+    {
+        profiler::phase p(prof,"bwt");
+        primary = rmatch::bwt_blockwise(t.data(),t.size(),memory,
+                ostreambuf_iterator<char>(out));
+        out->pubsync();
+    }
+    if (output) f.close();
+    if (output && !f) {
+        nag(app,"error writing file %s\n",output);
+        return 1;
+    }
+    fprintf(stderr,"%ld\n",primary);
+    return 0;
+}
+
 int main(int argc, char *const argv[])
 {
+    if (argc > 1 && !strcmp(argv[1],"bwt")) return bwt(argv[0],argc-1,argv+1);
 
     input in;
     if (!init(argc, argv, in)) return in.ret;
+    if (in.stream) return stream(argv[0],in);
+    if (in.fs.size() > 1 || in.l) return documents(argv[0],in);
+    if (in.win) return window(argv[0],in);
+    if (in.w == 8) return symbols<uint8_t>(argv[0],in);
+    if (in.w == 16) return symbols<uint16_t>(argv[0],in);
+    if (in.w == 32) return symbols<uint32_t>(argv[0],in);
+    if (!in.f.empty() && packable(in)) return bases(argv[0],in);
 
     vector<size_t,mallocator<size_t>> out;
-    size_t c;
-    timer t(in.p);
-    switch (in.m) {
-        case NAIVE:
-            rmatch::naive_match_range(in.t,in.b,in.e,back_inserter(out));
-            break;
-        case GS:
-            c = rmatch::gs_count_range(in.t,in.b,in.e,in.k);
-            break;
-        case C:
-            rmatch::stringRangeMatch(in.t,in.b,in.e,out);
-            break;
-        case Z:
-            rmatch::stringRangeMatchZ(in.t,in.b,in.e,out);
-            break;
-        case SA:
-            rmatch::rangeQuery(in.t,in.b,in.e,out);
-            break;
-        case KMP:
-            rmatch::kmp_match_range(in.t,in.b,in.e,back_inserter(out));
-            break;
+    profiler prof(in.p);
+    if (in.a) {
+        profiler::phase p(prof,"plan");
+        choose(argv[0],in.t.size(),max(in.b.size(),in.e.size()),in);
     }
-    t.stop();
+    size_t c = run_method(in.m,in.t,in.b,in.e,in.k,out,prof,in.o);
 
-    if (!in.s && in.m != GS) for (auto v: out) printf("%ld\n",v);
-    if (!in.s && in.m == GS) printf("%ld\n",c);
+    profiler::phase p(prof,"output");
+    if (!in.s && !in.n && in.m != GS) for (auto v: out) printf("%ld\n",v);
+    if (!in.s && (in.n || in.m == GS)) printf("%ld\n",c);
     return 0;
 }
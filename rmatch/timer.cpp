@@ -1,11 +1,19 @@
 /*
- * Timer class implementation
+ * Timer, performance counter and profiler class implementations
  *
  * Copyright (c) 2015 Jarno Leppänen
  */
 
 #include "timer.hpp"
 #include <cstdio>
+#include <cstring>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
 
 timer::timer():
     start(std::chrono::high_resolution_clock::now()),
@@ -35,3 +43,200 @@ void timer::stop()
     span = duration_cast<duration<double>>(stop-start).count();
     stopped = true;
 }
+
+double timer::seconds()
+{
+    stop();
+    return span;
+}
+
+#ifdef __linux__
+
+/* Open a single counter of the calling thread in the group of leader. */
+static int perf_open(uint64_t config, int leader)
+{
+    perf_event_attr attr;
+    memset(&attr,0,sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.disabled = leader == -1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    return syscall(__NR_perf_event_open,&attr,0,-1,leader,0);
+}
+
+perf_counters::perf_counters()
+{
+    static const uint64_t config[count] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES
+    };
+    for (int i = 0; i < count; ++i) fd[i] = -1;
+    for (int i = 0; i < count; ++i) {
+        fd[i] = perf_open(config[i],fd[0]);
+        if (fd[i] == -1) {
+            for (int j = 0; j < i; ++j) close(fd[j]);
+            fd[0] = -1;
+            return;
+        }
+    }
+    ioctl(fd[0],PERF_EVENT_IOC_RESET,PERF_IOC_FLAG_GROUP);
+    ioctl(fd[0],PERF_EVENT_IOC_ENABLE,PERF_IOC_FLAG_GROUP);
+}
+
+perf_counters::~perf_counters()
+{
+    if (!available()) return;
+    for (int i = 0; i < count; ++i) close(fd[i]);
+}
+
+bool perf_counters::available() const
+{
+    return fd[0] != -1;
+}
+
+bool perf_counters::read(perf_sample& s) const
+{
+    if (!available()) return false;
+    // PERF_FORMAT_GROUP layout: number of counters followed by the values
+    uint64_t buf[count+1];
+    if (::read(fd[0],buf,sizeof(buf)) != sizeof(buf)) return false;
+    if (buf[0] != count) return false;
+    s.cycles = buf[1];
+    s.instructions = buf[2];
+    s.cache_misses = buf[3];
+    s.branch_misses = buf[4];
+    return true;
+}
+
+#else
+
+perf_counters::perf_counters()
+{
+    fd[0] = -1;
+}
+
+perf_counters::~perf_counters()
+{
+}
+
+bool perf_counters::available() const
+{
+    return false;
+}
+
+bool perf_counters::read(perf_sample&) const
+{
+    return false;
+}
+
+#endif
+
+profiler::phase::phase(profiler& prof, const char *name):
+    prof(prof),
+    name(name),
+    start(std::chrono::high_resolution_clock::now()),
+    stopped(false)
+{
+    valid = prof.counters.read(counters);
+}
+
+profiler::phase::~phase()
+{
+    stop();
+}
+
+void profiler::phase::stop()
+{
+    if (stopped) return;
+    record r;
+    r.name = name;
+    prof.measure(r,start,counters,valid);
+    prof.records.push_back(r);
+    stopped = true;
+}
+
+profiler::profiler(bool print):
+    start(std::chrono::high_resolution_clock::now()),
+    stopped(false),
+    print(print)
+{
+    valid = counters.read(start_counters);
+    whole.name = "total";
+}
+
+profiler::~profiler()
+{
+    stop();
+    if (print) print_json(stdout);
+}
+
+void profiler::stop()
+{
+    if (stopped) return;
+    measure(whole,start,start_counters,valid);
+    stopped = true;
+}
+
+const std::vector<profiler::record>& profiler::phases() const
+{
+    return records;
+}
+
+const profiler::record& profiler::total()
+{
+    stop();
+    return whole;
+}
+
+void profiler::measure(record& r,
+        std::chrono::time_point<std::chrono::high_resolution_clock> start,
+        const perf_sample& counters, bool valid) const
+{
+    using namespace std::chrono;
+    perf_sample now;
+    r.valid = valid && this->counters.read(now);
+    r.span = duration_cast<duration<double>>(
+            high_resolution_clock::now()-start).count();
+    if (!r.valid) return;
+    r.counters.cycles = now.cycles-counters.cycles;
+    r.counters.instructions = now.instructions-counters.instructions;
+    r.counters.cache_misses = now.cache_misses-counters.cache_misses;
+    r.counters.branch_misses = now.branch_misses-counters.branch_misses;
+}
+
+/* Print a single record as a JSON object. Unavailable counters are null. */
+static void print_record(FILE *f, const profiler::record& r)
+{
+    fprintf(f,"{\"name\": \"%s\", \"time\": %f",r.name,r.span);
+    if (r.valid) {
+        fprintf(f,", \"cycles\": %llu, \"instructions\": %llu, "
+                "\"cache_misses\": %llu, \"branch_misses\": %llu}",
+                (unsigned long long)r.counters.cycles,
+                (unsigned long long)r.counters.instructions,
+                (unsigned long long)r.counters.cache_misses,
+                (unsigned long long)r.counters.branch_misses);
+    } else {
+        fprintf(f,", \"cycles\": null, \"instructions\": null, "
+                "\"cache_misses\": null, \"branch_misses\": null}");
+    }
+}
+
+void profiler::print_json(FILE *f)
+{
+    stop();
+    // the counters are not inherited by threads, so the work of worker
+    // threads shows up in the wall time only
+    fprintf(f,"{\n  \"counters\": \"calling thread\",\n  \"total\": ");
+    print_record(f,whole);
+    fprintf(f,",\n  \"phases\": [");
+    for (size_t i = 0; i < records.size(); ++i) {
+        fprintf(f,"%s\n    ",i ? "," : "");
+        print_record(f,records[i]);
+    }
+    fprintf(f,"\n  ]\n}\n");
+}
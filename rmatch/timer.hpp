@@ -1,5 +1,6 @@
 /*
- * A class enabling accurate timing using c++11 chrono features.
+ * A class enabling accurate timing using c++11 chrono features and a scoped
+ * phase profiler recording wall time and hardware performance counters.
  *
  * Copyright (c) 2015 Jarno Leppänen
  */
@@ -8,6 +9,9 @@
 #define TIMER_HPP
 
 #include <chrono>
+#include <vector>
+#include <cstdint>
+#include <cstdio>
 
 /**
  * Timer class enables accurate time measurement. Timing starts on object
@@ -43,6 +47,14 @@ public:
      */
     void stop();
 
+    /**
+     * Stops time measurement if it is still running and returns the measured
+     * time span in seconds.
+     *
+     * @return Measured time span in seconds.
+     */
+    double seconds();
+
 private:
     std::chrono::time_point<std::chrono::high_resolution_clock> start;
     double span;
@@ -50,4 +62,165 @@ private:
     bool print;
 };
 
+/* Values of the hardware performance counters read by perf_counters. */
+struct perf_sample {
+    uint64_t cycles;
+    uint64_t instructions;
+    uint64_t cache_misses;
+    uint64_t branch_misses;
+    perf_sample(): cycles(0), instructions(0), cache_misses(0),
+        branch_misses(0) {}
+};
+
+/**
+ * A group of hardware performance counters (cycles, instructions, cache misses
+ * and branch misses) of the calling thread opened with Linux perf_event_open().
+ * Threads started by the calling thread are not counted, as a counter group
+ * can't be read as a group once it is inherited. Counting starts on
+ * construction. If the counters can't be opened (e.g. due
+ * to kernel.perf_event_paranoid or a non-Linux platform), the group is
+ * marked unavailable and reading it always fails.
+ */
+class perf_counters {
+public:
+
+    /**
+     * Open and enable the counter group.
+     */
+    perf_counters();
+
+    /**
+     * Close the counter group.
+     */
+    ~perf_counters();
+
+    /**
+     * @return True, if the counters were opened successfully.
+     */
+    bool available() const;
+
+    /**
+     * Read the current counter values.
+     *
+     * @param s Destination sample.
+     * @return True, if the values were read successfully.
+     */
+    bool read(perf_sample& s) const;
+
+private:
+    perf_counters(const perf_counters&);
+    perf_counters& operator=(const perf_counters&);
+
+    static const int count = 4;
+    int fd[count];
+};
+
+/**
+ * Profiler class records the wall time and hardware performance counter
+ * deltas of consecutive named phases of a program run (e.g. suffix array
+ * construction, bound search and output) and of the whole run. Phases are
+ * recorded with scoped phase objects. The results are printed as a JSON
+ * object when the profiler is destroyed, if it was configured to do so.
+ */
+class profiler {
+public:
+
+    /**
+     * A scoped phase. Recording starts on construction and stops when stop()
+     * is called or when the object is destroyed.
+     */
+    class phase {
+    public:
+
+        /**
+         * Start recording a phase.
+         *
+         * @param prof Profiler the phase is recorded to.
+         * @param name Name of the phase. The string must outlive the
+         * profiler.
+         */
+        phase(profiler& prof, const char *name);
+
+        /**
+         * Stops recording the phase if it is still being recorded.
+         */
+        ~phase();
+
+        /**
+         * Explicitly stops recording the phase before object destruction.
+         */
+        void stop();
+
+    private:
+        profiler& prof;
+        const char *name;
+        std::chrono::time_point<std::chrono::high_resolution_clock> start;
+        perf_sample counters;
+        bool valid;
+        bool stopped;
+    };
+
+    /* Recorded values of a single phase. */
+    struct record {
+        const char *name;
+        double span;
+        perf_sample counters;
+        bool valid;
+    };
+
+    /**
+     * Construct a profiler. Recording of the whole run starts immediately.
+     *
+     * @param print If print is true, the recorded phases are printed as JSON
+     * to stdout when the object is destroyed.
+     */
+    profiler(bool print);
+
+    /**
+     * Destroys the profiler and prints the recorded phases if the object was
+     * configured to do so.
+     */
+    ~profiler();
+
+    /**
+     * Explicitly stops recording the whole run before object destruction.
+     */
+    void stop();
+
+    /**
+     * @return Recorded phases in the order they were stopped.
+     */
+    const std::vector<record>& phases() const;
+
+    /**
+     * Stops recording the whole run if it is still being recorded and returns
+     * the record for the whole run.
+     *
+     * @return Record for the whole run.
+     */
+    const record& total();
+
+    /**
+     * Print the recorded phases as a JSON object.
+     *
+     * @param f Destination file.
+     */
+    void print_json(FILE *f);
+
+private:
+    /* Fill record r with the deltas since the given starting point. */
+    void measure(record& r,
+            std::chrono::time_point<std::chrono::high_resolution_clock> start,
+            const perf_sample& counters, bool valid) const;
+
+    perf_counters counters;
+    std::vector<record> records;
+    std::chrono::time_point<std::chrono::high_resolution_clock> start;
+    perf_sample start_counters;
+    record whole;
+    bool valid;
+    bool stopped;
+    bool print;
+};
+
 #endif
@@ -87,3 +87,88 @@ TEST(CHROCHEMORE, RANDOM_TEST_BIG_LONG_PREFIX) {
     test.check(out);
 }
 
+
+/*!
+    check the O(m) space mode with precomputed maximum suffixes on a random case
+*/
+TEST(CHROCHEMORE, TABLE_RANDOM) {
+    TestCase<char> test = generator.generateRandomTestCase(100000, 443, 377);
+    vector<size_t> out;
+    stringRangeMatch(test.getData(), test.getLowerBound(), test.getUpperBound(), out, true);
+    test.check(out);
+}
+
+/*!
+    check that both modes give the same bits on periodic texts, where the
+    periodic skips leave states that are not in the table
+*/
+TEST(CHROCHEMORE, TABLE_PERIODIC) {
+    string fib = "a", prev = "b";
+    while (fib.length() < 50000)
+    {
+        string next = fib + prev;
+        prev = fib;
+        fib = next;
+    }
+    string per(50000, 'a');
+    for (size_t i = 0; i < per.length(); ++i) per[i] += i%3;
+    for (size_t i = 1000; i < per.length(); i += 4099) per[i] = 'd';
+    const string texts[] = { fib, per };
+    for (const string& text: texts)
+    {
+        const size_t starts[] = { 0, 1, 2, 5, 13 };
+        const size_t lengths[] = { 1, 3, 10, 100, 1000, 9999 };
+        for (size_t s: starts)
+        {
+            for (size_t m: lengths)
+            {
+                string pattern = text.substr(s, m);
+                bool same = lowerBound(text, pattern) ==
+                    lowerBound(text, pattern, MaximumSuffixTable<string>(pattern));
+                CHECK_EQUAL(true, same);
+                pattern[pattern.length()-1] = 'c';
+                same = lowerBound(text, pattern) ==
+                    lowerBound(text, pattern, MaximumSuffixTable<string>(pattern));
+                CHECK_EQUAL(true, same);
+            }
+        }
+    }
+}
+
+/*!
+    check range matches on periodic texts, where most of the bits are copied
+    on skips, against the naive search
+*/
+TEST(CHROCHEMORE, PERIODIC) {
+    string fib = "a", prev = "b";
+    while (fib.length() < 30000)
+    {
+        string next = fib + prev;
+        prev = fib;
+        fib = next;
+    }
+    string per(30000, 'a');
+    for (size_t i = 0; i < per.length(); ++i) per[i] += i%3;
+    for (size_t i = 1000; i < per.length(); i += 4099) per[i] = 'd';
+    const string texts[] = { fib, per };
+    for (const string& text: texts)
+    {
+        const size_t bounds[][4] = {
+            { 1, 100, 2, 1000 }, { 0, 17, 0, 5000 }, { 5, 3000, 13, 63 }
+        };
+        for (const auto& b: bounds)
+        {
+            string low = text.substr(b[0], b[1]), top = text.substr(b[2], b[3]);
+            if (top < low) swap(low, top);
+            vector<size_t> correct, out;
+            naive_match_range(text, low, top, back_inserter(correct));
+            stringRangeMatch(text, low, top, out);
+            bool same = out == correct;
+            CHECK_EQUAL(true, same);
+            out.clear();
+            stringRangeMatch(text, low, top, out, true);
+            same = out == correct;
+            CHECK_EQUAL(true, same);
+        }
+    }
+}
@@ -0,0 +1,87 @@
+/*!
+    Added to ensure that the compressed suffix array finds the same suffixes
+    as the suffix array
+*/
+
+#include "TestSuite.h"
+#include "CompressedSuffixArray.hpp"
+#include "naive_match.hpp"
+#include "check_macros.h"
+#include "TestCase.hpp"
+#include "TestGenerator.hpp"
+#include <string>
+#include <algorithm>
+#include <vector>
+#include <iterator>
+using namespace std;
+using namespace rmatch;
+
+/*!
+    checks a range query against the naive search and against the bounds of
+    the suffix array
+*/
+void compressedRangeTest(const string & data, const string & from, const string & to, size_t rate) {
+    vector<size_t> correct;
+    naive_match_range(data, from, to, back_inserter(correct));
+    CompressedSuffixArray<string> csa(data, rate);
+    vector<size_t> out = csa.rangeQuery(from, to);
+    sort(out.begin(), out.end());
+    bool same = out == correct;
+    CHECK_EQUAL(true, same);
+
+    SuffixArray<string> sa(data);
+    CHECK_EQUAL(sa.lowerBound(to), csa.lowerBound(to));
+    CHECK_EQUAL(sa.upperBound(from), csa.upperBound(from));
+}
+
+TEST(COMPRESSED_SUFFIX_ARRAY, SIMPLE_TEST) {
+    compressedRangeTest("banana", "0", "z", 4);
+    compressedRangeTest("banana", "an", "n", 1);
+    compressedRangeTest("asdf", "asdf", "f", 2);
+    compressedRangeTest("a\xf0z\x80" "a\xf0" "a", "a\xf0", "z", 3);
+    compressedRangeTest("", "a", "b", 3);
+}
+
+TEST(COMPRESSED_SUFFIX_ARRAY, TEST_GENERATOR_TEST_LONG) {
+    TestGenerator generator;
+    TestCase<char> test = generator.generateRandomTestCase(10000, 2, 3);
+    for (size_t rate : {1, 7, 32, 100}) {
+        compressedRangeTest(test.getData(), test.getLowerBound(), test.getUpperBound(), rate);
+    }
+    string periodic;
+    for (int i = 0; i < 1000; ++i) {
+        periodic += "abcab";
+    }
+    compressedRangeTest(periodic, "bca", "cab", 16);
+}
+
+/*!
+    checks that the positions of all suffixes, their ranks and the text can be
+    recovered and that the structure is smaller than the suffix array for a
+    repetitive text
+*/
+TEST(COMPRESSED_SUFFIX_ARRAY, LOCATE_EXTRACT) {
+    string data;
+    for (int i = 0; i < 2000; ++i) {
+        data += "mississippi";
+    }
+    SuffixArray<string> sa(data);
+    CompressedSuffixArray<string> csa(data, 16);
+    bool same = true;
+    for (size_t r = 0; r < data.size(); ++r) {
+        if (csa.locate(r) != size_t(sa.m_array[r]) || csa.inverse(sa.m_array[r]) != r) {
+            same = false;
+        }
+    }
+    CHECK_EQUAL(true, same);
+    string text;
+    csa.extract(0, data.size(), back_inserter(text));
+    same = text == data;
+    CHECK_EQUAL(true, same);
+    text.clear();
+    csa.extract(data.size()-5, 100, back_inserter(text));
+    same = text == data.substr(data.size()-5);
+    CHECK_EQUAL(true, same);
+    const bool smaller = csa.bytes() < data.size() * sizeof(int);
+    CHECK_EQUAL(true, smaller);
+}
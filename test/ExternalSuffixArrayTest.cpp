@@ -0,0 +1,86 @@
+/*!
+    Added to ensure that the suffix array built in bounded memory is the same
+    as the one built in memory
+*/
+
+#include "TestSuite.h"
+#include "ExternalSuffixArray.hpp"
+#include "naive_match.hpp"
+#include "check_macros.h"
+#include "TestGenerator.hpp"
+#include <string>
+#include <algorithm>
+#include <vector>
+#include <iterator>
+#include <fstream>
+#include <cstdlib>
+#include <unistd.h>
+using namespace std;
+using namespace rmatch;
+
+/*!
+    writes \a data to a new temporary file and returns its name
+*/
+string writeTemporary(const string & data) {
+    char name[] = "/tmp/rmatch-test-XXXXXX";
+    int fd = mkstemp(name);
+    close(fd);
+    ofstream(name, ios::binary) << data;
+    return name;
+}
+
+/*!
+    builds the suffix array file of \a data with \a budget bytes of memory and
+    compares it with the suffix array and a range query with the naive search
+*/
+void externalTest(const string & data, size_t budget, const string & from, const string & to) {
+    const string text = writeTemporary(data);
+    const string index = text + ".sa";
+    buildSuffixArrayFile(text, index, budget, "/tmp");
+    {
+        DiskSuffixArray disk(text, index);
+        SuffixArray<string> sa(data);
+        bool same = disk.size() == data.size();
+        for (size_t i = 0; same && i < data.size(); ++i) {
+            same = disk[i] == size_t(sa.m_array[i]);
+        }
+        CHECK_EQUAL(true, same);
+
+        vector<size_t> correct;
+        naive_match_range(data, from, to, back_inserter(correct));
+        vector<size_t> out = disk.rangeQuery(from, to);
+        sort(out.begin(), out.end());
+        same = out == correct;
+        CHECK_EQUAL(true, same);
+    }
+    unlink(index.c_str());
+    unlink(text.c_str());
+}
+
+TEST(EXTERNAL_SUFFIX_ARRAY, IN_MEMORY) {
+    externalTest("banana", 1 << 20, "an", "n");
+    externalTest("a\xf0z\x80" "a\xf0" "a", 1 << 20, "a\xf0", "z");
+}
+
+TEST(EXTERNAL_SUFFIX_ARRAY, BUCKETS) {
+    TestGenerator generator;
+    TestCase<char> test = generator.generateRandomTestCase(20000, 2, 3);
+    externalTest(test.getData(), 4096, test.getLowerBound(), test.getUpperBound());
+    string signedText;
+    for (int i = 0; i < 5000; ++i) {
+        signedText += char(i * 7919 % 251 - 120);
+    }
+    externalTest(signedText, 2048, "\x90", "\x10");
+}
+
+/*!
+    repetitive texts need splitters longer than the initial prefix length
+*/
+TEST(EXTERNAL_SUFFIX_ARRAY, REPETITIVE) {
+    externalTest(string(3000, 'a'), 2048, "aaaa", "b");
+    string periodic;
+    for (int i = 0; i < 1000; ++i) {
+        periodic += "abcab";
+    }
+    externalTest(periodic, 2048, "bca", "cab");
+}
@@ -0,0 +1,94 @@
+/*!
+    Added to ensure that the generalized suffix array finds the same suffixes
+    in each document as searching the documents one by one
+*/
+
+#include "TestSuite.h"
+#include "GeneralizedSuffixArray.hpp"
+#include "naive_match.hpp"
+#include "check_macros.h"
+#include "TestCase.hpp"
+#include "TestGenerator.hpp"
+#include <string>
+#include <algorithm>
+#include <vector>
+#include <iterator>
+#include <utility>
+using namespace std;
+using namespace rmatch;
+
+/*!
+    checks the positions, the per document counts and the distinct documents
+    of a range query against the naive search of each document
+*/
+void generalizedRangeTest(const vector<string> & docs, const string & from, const string & to) {
+    vector<pair<size_t, size_t> > correct;
+    vector<pair<size_t, size_t> > correctCounts;
+    vector<size_t> correctDocs;
+    for (size_t d = 0; d < docs.size(); ++d) {
+        vector<size_t> positions;
+        naive_match_range(docs[d], from, to, back_inserter(positions));
+        for (size_t p : positions) {
+            correct.push_back(make_pair(d, p));
+        }
+        if (!positions.empty()) {
+            correctCounts.push_back(make_pair(d, positions.size()));
+            correctDocs.push_back(d);
+        }
+    }
+    sort(correct.begin(), correct.end());
+
+    GeneralizedSuffixArray<string> gsa(docs);
+    vector<pair<size_t, size_t> > out;
+    for (const DocumentPosition & p : gsa.rangeQuery(from, to)) {
+        out.push_back(make_pair(p.doc, p.offset));
+    }
+    sort(out.begin(), out.end());
+    bool same = out == correct;
+    CHECK_EQUAL(true, same);
+    CHECK_EQUAL(correct.size(), gsa.count(from, to));
+    same = gsa.documentCounts(from, to) == correctCounts;
+    CHECK_EQUAL(true, same);
+    same = gsa.distinctDocuments(from, to) == correctDocs;
+    CHECK_EQUAL(true, same);
+}
+
+TEST(GENERALIZED_SUFFIX_ARRAY, SIMPLE_TEST) {
+    generalizedRangeTest({"banana", "ananas", "bandana"}, "an", "ao");
+    generalizedRangeTest({"banana", "", "nab"}, "a", "c");
+    generalizedRangeTest({"ab", "abab", "b"}, "ab", "b");
+    generalizedRangeTest({"a\xf0z\x80", "a\xf0" "a"}, "a\xf0", "z");
+    generalizedRangeTest({"asdf"}, "x", "z");
+    generalizedRangeTest({}, "a", "b");
+}
+
+/*!
+    a suffix ending at the end of its document is not continued by the
+    next document
+*/
+TEST(GENERALIZED_SUFFIX_ARRAY, DOCUMENT_BOUNDARY_TEST) {
+    GeneralizedSuffixArray<string> gsa(vector<string>{"xa", "bx", "ab"});
+    CHECK_EQUAL(1, gsa.count("ab", "ac"));
+    vector<DocumentPosition> out = gsa.rangeQuery("ab", "ac");
+    CHECK_EQUAL(2, out[0].doc);
+    CHECK_EQUAL(0, out[0].offset);
+    CHECK_EQUAL(6, gsa.size());
+    CHECK_EQUAL(3, gsa.documents());
+}
+
+TEST(GENERALIZED_SUFFIX_ARRAY, TEST_GENERATOR_TEST_LONG) {
+    TestGenerator generator;
+    vector<string> docs;
+    for (int i = 0; i < 300; ++i) {
+        docs.push_back(generator.generateRandomTestCase(50 + i % 200, 2, 3).getData());
+    }
+    TestCase<char> test = generator.generateRandomTestCase(10, 2, 3);
+    generalizedRangeTest(docs, test.getLowerBound(), test.getUpperBound());
+    generalizedRangeTest(docs, "", "\x7f");
+
+    vector<string> periodic(100, "abcab");
+    for (size_t i = 0; i < periodic.size(); ++i) {
+        periodic[i] += string(i % 7, 'c');
+    }
+    generalizedRangeTest(periodic, "bca", "cac");
+}
@@ -0,0 +1,74 @@
+/*!
+    Added to ensure that appending to the incremental suffix array finds the
+    same suffixes as searching the whole text
+*/
+
+#include "TestSuite.h"
+#include "IncrementalSuffixArray.hpp"
+#include "naive_match.hpp"
+#include "check_macros.h"
+#include "TestCase.hpp"
+#include "TestGenerator.hpp"
+#include <string>
+#include <algorithm>
+#include <vector>
+#include <iterator>
+using namespace std;
+using namespace rmatch;
+
+/*!
+    checks a range query and a count against the naive search of the text
+*/
+void incrementalRangeTest(const IncrementalSuffixArray<string> & isa, const string & from, const string & to) {
+    vector<size_t> correct;
+    naive_match_range(isa.data(), from, to, back_inserter(correct));
+    vector<size_t> out = isa.rangeQuery(from, to);
+    sort(out.begin(), out.end());
+    bool same = out == correct;
+    CHECK_EQUAL(true, same);
+    CHECK_EQUAL(correct.size(), isa.count(from, to));
+}
+
+TEST(INCREMENTAL_SUFFIX_ARRAY, SIMPLE_TEST) {
+    IncrementalSuffixArray<string> isa;
+    incrementalRangeTest(isa, "a", "b");
+    for (const char * s : {"ban", "an", "a", "", "bandana", "s"}) {
+        isa.append(s);
+        incrementalRangeTest(isa, "an", "ao");
+        incrementalRangeTest(isa, "ana", "b");
+        incrementalRangeTest(isa, "a", "bandanas");
+        incrementalRangeTest(isa, "", "z");
+    }
+    CHECK_EQUAL(14, isa.size());
+    incrementalRangeTest(isa, "a\xf0", "z");
+    isa.append("a\xf0z\x80");
+    incrementalRangeTest(isa, "a\xf0", "z");
+}
+
+/*!
+    matches spanning many segments are found and the number of segments
+    stays logarithmic in the number of appends
+*/
+TEST(INCREMENTAL_SUFFIX_ARRAY, SEGMENT_TEST) {
+    IncrementalSuffixArray<string> isa("abcab");
+    for (int i = 0; i < 1000; ++i) {
+        isa.append(i % 3 ? "c" : "ab");
+    }
+    bool few = isa.segments() <= 2 * 11;
+    CHECK_EQUAL(true, few);
+    incrementalRangeTest(isa, "bcabcc", "cc");
+    incrementalRangeTest(isa, "abccabcc", "abccabccabccc");
+    incrementalRangeTest(isa, "c", "cc");
+}
+
+TEST(INCREMENTAL_SUFFIX_ARRAY, TEST_GENERATOR_TEST_LONG) {
+    TestGenerator generator;
+    IncrementalSuffixArray<string> isa;
+    for (int i = 0; i < 200; ++i) {
+        isa.append(generator.generateRandomTestCase(1 + i * 7 % 120, 2, 3).getData());
+        if (i % 20 == 19) {
+            TestCase<char> test = generator.generateRandomTestCase(10, 2, 6);
+            incrementalRangeTest(isa, test.getLowerBound(), test.getUpperBound());
+        }
+    }
+}
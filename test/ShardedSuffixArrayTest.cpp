@@ -0,0 +1,59 @@
+/*!
+    Added to ensure that the sharded suffix array finds the same suffixes as
+    the naive search regardless of the number of shards and the overlap
+*/
+
+#include "TestSuite.h"
+#include "ShardedSuffixArray.hpp"
+#include "naive_match.hpp"
+#include "check_macros.h"
+#include "TestCase.hpp"
+#include "TestGenerator.hpp"
+#include <string>
+#include <algorithm>
+#include <vector>
+#include <iterator>
+using namespace std;
+using namespace rmatch;
+
+/*!
+    checks a range query and a count against the naive search
+*/
+void shardedRangeTest(const string & data, const string & from, const string & to,
+        size_t shards, size_t overlap, unsigned threads) {
+    vector<size_t> correct;
+    naive_match_range(data, from, to, back_inserter(correct));
+    sort(correct.begin(), correct.end());
+    ShardedSuffixArray<string> ssa(data, shards, overlap, threads);
+    bool same = ssa.rangeQuery(from, to) == correct;
+    CHECK_EQUAL(true, same);
+    CHECK_EQUAL(correct.size(), ssa.count(from, to));
+}
+
+TEST(SHARDED_SUFFIX_ARRAY, SIMPLE_TEST) {
+    for (size_t shards : {1, 2, 3, 7}) {
+        for (size_t overlap : {0, 1, 4}) {
+            shardedRangeTest("banana", "an", "ao", shards, overlap, 2);
+            shardedRangeTest("banana", "ana", "b", shards, overlap, 1);
+            shardedRangeTest("abracadabra", "abra", "abracadabraz", shards, overlap, 3);
+            shardedRangeTest("a\xf0z\x80" "a\xf0" "a", "a\xf0", "z", shards, overlap, 2);
+        }
+    }
+    shardedRangeTest("", "a", "b", 4, 2, 2);
+    ShardedSuffixArray<string> ssa("ab", 5);
+    CHECK_EQUAL(2, ssa.shards());
+}
+
+TEST(SHARDED_SUFFIX_ARRAY, TEST_GENERATOR_TEST_LONG) {
+    TestGenerator generator;
+    TestCase<char> test = generator.generateRandomTestCase(20000, 2, 3);
+    for (size_t shards : {1, 4, 13}) {
+        shardedRangeTest(test.getData(), test.getLowerBound(), test.getUpperBound(), shards, 16, 4);
+    }
+    string periodic;
+    for (int i = 0; i < 1000; ++i) {
+        periodic += "abcab";
+    }
+    shardedRangeTest(periodic, "bcabcabcabcab", "cab", 9, 3, 4);
+    shardedRangeTest(periodic, "bca", "cab", 9, 3, 4);
+}
@@ -4,6 +4,7 @@
 
 #include "TestSuite.h"
 #include "SuffixArray.hpp"
+#include "naive_match.hpp"
 #include "check_macros.h"
 #include "TestCase.hpp"
 #include "TestGenerator.hpp"
@@ -11,6 +12,8 @@
 #include <string>
 #include <algorithm>
 #include <vector>
+#include <iterator>
+#include <random>
 using namespace std;
 using namespace rmatch;
 
@@ -91,3 +94,123 @@ TEST(SUFFIX_ARRAY, TEST_BORDER_CASE) {
     sort(out.begin(), out.end());
     CHECK_EQUAL(true, test.naiveCheck(out));
 }
+
+/*!
+    check that characters with the sign bit set are sorted in the same order
+    as they are compared by the other algorithms
+*/
+TEST(SUFFIX_ARRAY, SIGNED_CHARACTERS) {
+    basic_string<char> data = "a\xf0z\x80" "a\xf0" "a";
+    basic_string<char> from = "a\xf0";
+    basic_string<char> to = "z";
+    vector<size_t> correct;
+    naive_match_range(data, from, to, back_inserter(correct));
+    SuffixArray<string> arr = SuffixArray<string>(data);
+    vector<size_t> out = arr.rangeQuery(from, to);
+    sort(out.begin(), out.end());
+    bool same = out == correct;
+    CHECK_EQUAL(true, same);
+}
+
+/*!
+    check that the window queries find the matching suffixes starting in the
+    window in text order
+*/
+TEST(SUFFIX_ARRAY, WINDOW_QUERY) {
+    TestGenerator generator;
+    TestCase<char> test = generator.generateRandomTestCase(5000, 1, 2);
+    vector<size_t> all;
+    naive_match_range(test.getData(), test.getLowerBound(), test.getUpperBound(), back_inserter(all));
+    SuffixArray<string> arr = SuffixArray<string>(test.getData());
+    const size_t windows[][2] = {{0, 5000}, {0, 0}, {100, 2000}, {4999, 5000}, {3000, 100000}, {2000, 100}};
+    for (const auto & w : windows) {
+        vector<size_t> correct;
+        for (size_t p : all) {
+            if (p >= w[0] && p < w[1]) {
+                correct.push_back(p);
+            }
+        }
+        bool same = arr.windowQuery(test.getLowerBound(), test.getUpperBound(), w[0], w[1]) == correct;
+        CHECK_EQUAL(true, same);
+        CHECK_EQUAL(correct.size(), arr.windowCount(test.getLowerBound(), test.getUpperBound(), w[0], w[1]));
+        // a reused output container is replaced, not appended to
+        vector<size_t> reused(3, 7);
+        arr.windowQuery(test.getLowerBound(), test.getUpperBound(), w[0], w[1], reused);
+        same = reused == correct;
+        CHECK_EQUAL(true, same);
+    }
+}
+
+/*!
+    check that the smallest positions and the samples of a suffix array
+    interval are drawn from the matching suffixes
+*/
+TEST(SUFFIX_ARRAY, SMALLEST_AND_SAMPLED_POSITIONS) {
+    TestGenerator generator;
+    TestCase<char> test = generator.generateRandomTestCase(5000, 1, 2);
+    const string & from = test.getLowerBound();
+    const string & to = test.getUpperBound();
+    vector<size_t> all;
+    naive_match_range(test.getData(), from, to, back_inserter(all));
+    SuffixArray<string> arr = SuffixArray<string>(test.getData(), false);
+    for (size_t k : {0, 1, 10, 100, 100000}) {
+        vector<size_t> correct(all.begin(), all.begin() + min(k, all.size()));
+        bool same = arr.smallestPositions(from, to, k) == correct;
+        CHECK_EQUAL(true, same);
+
+        vector<size_t> sample = arr.samplePositions(from, to, k, 42);
+        CHECK_EQUAL(min(k, all.size()), sample.size());
+        bool sorted = is_sorted(sample.begin(), sample.end()) &&
+            adjacent_find(sample.begin(), sample.end()) == sample.end();
+        CHECK_EQUAL(true, sorted);
+        bool subset = includes(all.begin(), all.end(), sample.begin(), sample.end());
+        CHECK_EQUAL(true, subset);
+        same = arr.samplePositions(from, to, k, 42) == sample;
+        CHECK_EQUAL(true, same);
+    }
+    bool different = arr.samplePositions(from, to, 10, 1) != arr.samplePositions(from, to, 10, 2);
+    CHECK_EQUAL(true, different);
+    CHECK_EQUAL(0, arr.smallestPositions("z", "a", 5).size());
+}
+
+/*!
+    check that every matching position is sampled about equally often
+*/
+TEST(SUFFIX_ARRAY, UNIFORM_SAMPLE) {
+    SuffixArray<string> arr = SuffixArray<string>("abababababababababab");
+    vector<size_t> hits(20);
+    for (uint64_t seed = 0; seed < 2000; ++seed) {
+        for (size_t p : arr.samplePositions("ab", "ac", 2, seed)) {
+            ++hits[p];
+        }
+    }
+    // each of the 10 matches is expected 400 times
+    bool uniform = true;
+    for (size_t p = 0; p < hits.size(); ++p) {
+        uniform = uniform && (p % 2 ? hits[p] == 0 : hits[p] > 300 && hits[p] < 500);
+    }
+    CHECK_EQUAL(true, uniform);
+}
+
+/*!
+    check that the positions are reported in text order for sparse and dense
+    intervals of the suffix array
+*/
+TEST(SUFFIX_ARRAY, SORTED_RANGE_QUERY) {
+    mt19937 rng(3);
+    string data;
+    for (int i = 0; i < 100000; ++i) {
+        data.push_back("acgt"[rng() % 4]);
+    }
+    SuffixArray<string> arr = SuffixArray<string>(data, false);
+    // about 25000, 390 and 100 matches are sorted by the bit vector, by
+    // radix sort and by comparisons
+    vector<pair<string, string> > ranges = {{"a", "b"}, {"acgt", "acgu"}, {"gtcag", "gtcah"},
+        {"", "z"}, {"z", "a"}};
+    for (const auto & r : ranges) {
+        vector<size_t> correct;
+        naive_match_range(data, r.first, r.second, back_inserter(correct));
+        bool same = arr.sortedRangeQuery(r.first, r.second) == correct;
+        CHECK_EQUAL(true, same);
+    }
+}
@@ -0,0 +1,40 @@
+/*!
+    Added to check the bit manipulation helpers shared by the algorithms
+*/
+
+#include "TestSuite.h"
+#include "Util.hpp"
+#include "check_macros.h"
+#include <vector>
+#include <iterator>
+#include <boost/dynamic_bitset.hpp>
+using namespace std;
+using namespace rmatch;
+
+/*!
+    check that copying bits a block at a time gives the same bits as copying
+    one bit at a time, also when the ranges overlap
+*/
+TEST(UTIL, COPY_BITS) {
+    const size_t n = 1000;
+    boost::dynamic_bitset<> ref(n);
+    for (size_t i = 0; i < n; ++i) ref[i] = (i*i + i/7) % 3 == 0;
+    vector<vector<size_t>> cases = {
+        { 1, 0, 999 }, { 65, 1, 900 }, { 200, 100, 300 }, { 64, 0, 128 },
+        { 130, 3, 700 }, { 500, 437, 63 }, { 10, 10, 50 }, { 999, 0, 1 },
+        { 300, 2, 0 }, { 129, 128, 500 }
+    };
+    for (size_t d = 0; d < 140; ++d) cases.push_back({ 5+d, 5, (d*37) % 600 });
+    for (const auto& c: cases)
+    {
+        std::vector<BitBlock> words;
+        boost::to_block_range(ref, std::back_inserter(words));
+        copyBits(words, c[0], c[1], c[2]);
+        boost::dynamic_bitset<> bits(words.begin(), words.end());
+        bits.resize(n);
+        boost::dynamic_bitset<> correct = ref;
+        for (size_t f = 0; f < c[2]; ++f) correct[c[0]+f] = correct[c[1]+f];
+        bool same = bits == correct;
+        CHECK_EQUAL(true, same);
+    }
+}
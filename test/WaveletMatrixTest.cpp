@@ -0,0 +1,64 @@
+/*!
+    Added to ensure that the wavelet tree counts and reports the same values
+    as scanning the sequence
+*/
+
+#include "TestSuite.h"
+#include "WaveletMatrix.hpp"
+#include "check_macros.h"
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <random>
+using namespace std;
+using namespace rmatch;
+
+/*!
+    checks the values in [lo,hi) at the indices [s,e) against a scan
+*/
+void waveletRangeTest(const WaveletMatrix & wm, const vector<size_t> & values,
+        size_t s, size_t e, size_t lo, size_t hi) {
+    vector<size_t> correct;
+    for (size_t i = s; i < e; ++i) {
+        if (values[i] >= lo && values[i] < hi) {
+            correct.push_back(values[i]);
+        }
+    }
+    sort(correct.begin(), correct.end());
+    vector<size_t> out;
+    wm.report(s, e, lo, hi, back_inserter(out));
+    bool same = out == correct;
+    CHECK_EQUAL(true, same);
+    CHECK_EQUAL(correct.size(), wm.count(s, e, lo, hi));
+}
+
+TEST(WAVELET_MATRIX, SIMPLE_TEST) {
+    vector<size_t> values = {5, 0, 3, 3, 7, 1, 6, 2, 0, 4};
+    WaveletMatrix wm(values.begin(), values.end());
+    CHECK_EQUAL(10, wm.size());
+    waveletRangeTest(wm, values, 0, 10, 0, 8);
+    waveletRangeTest(wm, values, 2, 7, 3, 7);
+    waveletRangeTest(wm, values, 1, 9, 0, 1);
+    waveletRangeTest(wm, values, 4, 4, 0, 8);
+    waveletRangeTest(wm, values, 0, 10, 8, 100);
+    waveletRangeTest(wm, values, 0, 10, 6, 2);
+
+    vector<size_t> zeros(3, 0);
+    WaveletMatrix wz(zeros.begin(), zeros.end());
+    waveletRangeTest(wz, zeros, 0, 3, 0, 1);
+    waveletRangeTest(wz, zeros, 1, 3, 1, 5);
+}
+
+TEST(WAVELET_MATRIX, PERMUTATION_TEST) {
+    mt19937 rng(7);
+    vector<size_t> values(3000);
+    for (size_t i = 0; i < values.size(); ++i) {
+        values[i] = i;
+    }
+    shuffle(values.begin(), values.end(), rng);
+    WaveletMatrix wm(values.begin(), values.end());
+    for (int q = 0; q < 50; ++q) {
+        size_t s = rng() % 3001, e = rng() % 3001, lo = rng() % 3100, hi = rng() % 3100;
+        waveletRangeTest(wm, values, min(s, e), max(s, e), min(lo, hi), max(lo, hi));
+    }
+}
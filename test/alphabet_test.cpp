@@ -0,0 +1,102 @@
+#include "alphabet.hpp"
+#include "ProjectInc.hpp"
+#include "SuffixArray.hpp"
+#include "kmp_match.hpp"
+#include "check_macros.h"
+#include <vector>
+#include <string>
+#include <iterator>
+#include <algorithm>
+#include <cstdint>
+
+using namespace rmatch;
+
+using namespace std;
+
+/*!
+    check that the codes are dense and ordered the same way as the symbols
+*/
+template <typename symbol_type>
+void alphabet_test(const vector<symbol_type>& t, size_t sigma)
+{
+    alphabet<symbol_type> a(t.begin(), t.end());
+    CHECK_EQUAL(sigma, a.size());
+    bool ordered = true;
+    for (size_t i = 0; i < t.size(); ++i) {
+        for (size_t j = 0; j < t.size(); ++j) {
+            if ((t[i] < t[j]) != (a.code(t[i]) < a.code(t[j]))) ordered = false;
+        }
+        if (a.code(t[i]) >= sigma || a.symbol(a.code(t[i])) != t[i]) {
+            ordered = false;
+        }
+    }
+    CHECK_EQUAL(true, ordered);
+}
+
+TEST(ALPHABET, CODES) {
+    alphabet_test(vector<char>{ 'a', -3, 100, 'a', 0, -128, 127 }, 6);
+    alphabet_test(vector<uint16_t>{ 7, 65535, 7, 300, 0 }, 4);
+    alphabet_test(vector<uint32_t>{ 4000000000u, 3, 3, 70000, 1 }, 4);
+    alphabet_test(vector<uint32_t>{}, 0);
+}
+
+/*!
+    random text of n symbols drawn from sigma values spread over the range of
+    the symbol type
+*/
+template <typename symbol_type>
+vector<symbol_type> symbol_text(size_t n, size_t sigma, symbol_type step)
+{
+    vector<symbol_type> t(n);
+    uint64_t x = 12345;
+    for (size_t i = 0; i < n; ++i) {
+        x = x*6364136223846793005ull + 1442695040888963407ull;
+        t[i] = symbol_type((x >> 33) % sigma) * step;
+    }
+    return t;
+}
+
+/*!
+    check that every algorithm finds the same suffixes as the naive search on
+    a text of integer symbols
+*/
+template <typename symbol_type>
+void symbols_test(const vector<symbol_type>& t,
+        const vector<symbol_type>& l, const vector<symbol_type>& u)
+{
+    vector<size_t> correct;
+    naive_match_range(t, l, u, back_inserter(correct));
+
+    vector<size_t> r;
+    kmp_match_range(t, l, u, back_inserter(r));
+    bool same = r == correct;
+    CHECK_EQUAL(true, same);
+
+    CHECK_EQUAL(correct.size(), gs_count_range(t, l, u, size_t(3)));
+
+    same = stringRangeMatch(t, l, u) == correct;
+    CHECK_EQUAL(true, same);
+
+    same = stringRangeMatchZ(t, l, u) == correct;
+    CHECK_EQUAL(true, same);
+
+    vector<size_t> s = SuffixArray<vector<symbol_type>>(t).rangeQuery(l, u);
+    sort(s.begin(), s.end());
+    same = s == correct;
+    CHECK_EQUAL(true, same);
+}
+
+TEST(ALPHABET, U16) {
+    vector<uint16_t> t = symbol_text<uint16_t>(20000, 5, 10007);
+    symbols_test(t, vector<uint16_t>(t.begin()+10, t.begin()+13),
+            vector<uint16_t>(t.begin()+500, t.begin()+502));
+    symbols_test(t, vector<uint16_t>(), vector<uint16_t>(1, 65535));
+}
+
+TEST(ALPHABET, U32) {
+    vector<uint32_t> t = symbol_text<uint32_t>(20000, 7, 600000007u);
+    symbols_test(t, vector<uint32_t>(t.begin()+10, t.begin()+13),
+            vector<uint32_t>(t.begin()+500, t.begin()+504));
+    vector<uint32_t> p(t.begin(), t.begin()+2000);
+    symbols_test(p, vector<uint32_t>(p.begin()+1, p.begin()+4), p);
+}
@@ -0,0 +1,87 @@
+#include "batch_match.hpp"
+#include "check_macros.h"
+#include "TestGenerator.hpp"
+#include <vector>
+#include <string>
+#include <iterator>
+
+using namespace rmatch;
+
+using namespace std;
+
+/*!
+    split a text into documents of varying lengths, some of them empty
+*/
+vector<size_t> batch_offsets(size_t n, size_t seed)
+{
+    vector<size_t> offsets(1, 0);
+    for (size_t d = 0; offsets.back() < n; ++d) {
+        size_t len = (d*seed + d*d) % 97;
+        if (d % 500 == 7) len = 5000; // a few long documents to steal from
+        offsets.push_back(min(n, offsets.back() + len));
+    }
+    return offsets;
+}
+
+/*!
+    check the counts and matches of every document against searching the
+    documents one at a time, for several numbers of threads
+*/
+void batch_test(const string& t, const string& l, const string& u)
+{
+    vector<size_t> offsets = batch_offsets(t.size(), 31);
+    const size_t docs = offsets.size()-1;
+    vector<size_t> correct_counts;
+    batch_matches correct;
+    for (size_t d = 0; d < docs; ++d) {
+        string x = t.substr(offsets[d], offsets[d+1]-offsets[d]);
+        vector<size_t> r;
+        kmp_match_range(x, l, u, back_inserter(r));
+        correct_counts.push_back(r.size());
+        for (size_t i: r) {
+            correct.doc.push_back(d);
+            correct.pos.push_back(i);
+        }
+    }
+    const gs_pattern<size_t> lg(l, 3), ug(u, 3);
+    const kmp_pattern<size_t> lk(l), uk(u);
+    const unsigned threads[] = { 1, 2, 7 };
+    for (unsigned th: threads) {
+        vector<size_t> counts(docs);
+        batch_count_range(t.data(), offsets.data(), docs, lg, ug,
+                counts.data(), th);
+        bool same = counts == correct_counts;
+        CHECK_EQUAL(true, same);
+
+        batch_matches r;
+        batch_match_range(t.data(), offsets.data(), docs, lk, uk, r, th);
+        same = r.doc == correct.doc && r.pos == correct.pos;
+        CHECK_EQUAL(true, same);
+    }
+    bool same = batch_count_range(t, offsets, l, u, 3) == correct_counts;
+    CHECK_EQUAL(true, same);
+    batch_matches r = batch_match_range(t, offsets, l, u);
+    same = r.doc == correct.doc && r.pos == correct.pos;
+    CHECK_EQUAL(true, same);
+}
+
+TEST(BATCH, RANDOM) {
+    TestGenerator generator;
+    string t = generator.generateRandomString(200000);
+    batch_test(t, t.substr(100, 2), t.substr(200, 3));
+    batch_test(t, "", t.substr(5000, 40));
+    batch_test(t, t.substr(7, 1), "");
+}
+
+TEST(BATCH, PERIODIC) {
+    string p(100000, 'a');
+    for (size_t i = 0; i < p.size(); ++i) p[i] += i%3;
+    batch_test(p, p.substr(1, 10), p.substr(2, 100));
+}
+
+TEST(BATCH, EMPTY) {
+    vector<size_t> offsets(1, 0);
+    batch_matches r = batch_match_range("", offsets, "a", "b");
+    CHECK_EQUAL(size_t(0), r.pos.size());
+    CHECK_EQUAL(size_t(0), batch_count_range("", offsets, "a", "b", 3).size());
+}
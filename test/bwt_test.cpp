@@ -0,0 +1,61 @@
+#include "bwt.hpp"
+#include "SuffixArray.hpp"
+#include "check_macros.h"
+#include "TestGenerator.hpp"
+#include <string>
+#include <vector>
+#include <iterator>
+
+using namespace rmatch;
+
+using namespace std;
+
+/*!
+    check the blockwise transform against the one read off the suffix array
+*/
+void bwt_test(const string& t, size_t memory)
+{
+    string correct;
+    size_t primary = 0;
+    if (!t.empty()) {
+        correct.push_back(t.back());
+        SuffixArray<string> sa(t, false);
+        for (size_t i = 0; i < t.size(); ++i) {
+            if (sa.m_array[i]) correct.push_back(t[sa.m_array[i]-1]);
+            else primary = i+1;
+        }
+    }
+    string r;
+    const size_t p = bwt_blockwise(t.data(), t.size(), memory,
+            back_inserter(r));
+    CHECK_EQUAL(primary, p);
+    bool same = r == correct;
+    CHECK_EQUAL(true, same);
+}
+
+TEST(BWT, SMALL) {
+    bwt_test("", 1024);
+    bwt_test("a", 1024);
+    bwt_test("banana", 1024);
+    bwt_test("banana", 8);
+    bwt_test("a\xf0z\x80" "a\xf0" "a", 16);
+}
+
+TEST(BWT, BLOCKS) {
+    TestGenerator generator;
+    TestCase<char> test = generator.generateRandomTestCase(20000, 1, 1);
+    bwt_test(test.getData(), 1 << 20);
+    bwt_test(test.getData(), 4096);
+    bwt_test(test.getData(), 256);
+    string s;
+    for (int i = 0; i < 5000; ++i) s += char(i * 7919 % 251 - 120);
+    bwt_test(s, 2048);
+}
+
+TEST(BWT, REPETITIVE) {
+    bwt_test(string(3000, 'a'), 2048);
+    string p;
+    for (int i = 0; i < 1000; ++i) p += "abcab";
+    bwt_test(p, 2048);
+    bwt_test(p + p, 512);
+}
@@ -2,6 +2,10 @@
 #include "check_macros.h"
 #include "TestCase.hpp"
 #include "TestGenerator.hpp"
+#include <deque>
+#include <vector>
+#include <algorithm>
+#include <iterator>
 
 using namespace rmatch;
 
@@ -135,3 +139,97 @@ TEST(GS, RANDOM_TEST_BIG) {
 TEST(GS, RANDOM_TEST_BIG_LONG_PREFIX) {
     gs_test(1000000, 1773, 4565);
 }
+
+/*!
+    check that the vectorized prefix extension of character strings counts
+    the same suffixes as the generic one on a periodic text with long matches
+*/
+void gs_contiguous_test(const string& t, const string& l, const string& u)
+{
+    deque<char> td(t.begin(),t.end()), ld(l.begin(),l.end()),
+        ud(u.begin(),u.end());
+    for (size_t k = 3; k <= 4; ++k) {
+        size_t generic = gs_count_range(td,ld,ud,k);
+        size_t contiguous = gs_count_range(t,l,u,k);
+        CHECK_EQUAL(generic, contiguous);
+    }
+}
+
+TEST(GS, CONTIGUOUS) {
+    string p(1 << 16, 'a');
+    for (size_t i = 0; i < p.size(); ++i) p[i] += i%3;
+    for (size_t i = 1000; i < p.size(); i += 4099) p[i] = 'd';
+    gs_contiguous_test(p, p.substr(1, 100), p.substr(2, 1000));
+    gs_contiguous_test(p, p.substr(0, 17), p.substr(0, 5000));
+    gs_contiguous_test(p, p.substr(990, 3000), p.substr(2, 63));
+}
+
+/*!
+    check that counting several patterns over interleaved blocks of the text
+    gives the same counts as counting them one at a time
+*/
+TEST(GS, MULTI) {
+    TestGenerator generator;
+    const string t = generator.generateRandomString(100000);
+    vector<string> v;
+    for (size_t i = 0; i < 20; ++i) v.push_back(t.substr(i*4000, i*37%200));
+    v.push_back(t);
+    const vector<string>& ps = v;
+    vector<size_t> correct;
+    for (const string& p: ps) {
+        correct.push_back(gs_count_less(t.begin(), t.size(), p.begin(),
+                    p.size(), size_t(3)));
+    }
+    const size_t blocks[] = { 1, 7, 1000, 1 << 20 };
+    for (size_t block: blocks) {
+        vector<size_t> counts;
+        gs_count_less_multi(t.begin(), t.size(), ps.begin(), ps.end(),
+                size_t(3), back_inserter(counts), block);
+        bool same = counts == correct;
+        CHECK_EQUAL(true, same);
+    }
+}
+
+/*!
+    check a histogram of the suffixes over sorted bucket bounds
+*/
+TEST(GS, BUCKETS) {
+    TestGenerator generator;
+    const string t = generator.generateRandomString(50000);
+    vector<string> bs;
+    for (size_t i = 0; i < 30; ++i) bs.push_back(t.substr(i*1500, 1+i%5));
+    bs.push_back("");
+    sort(bs.begin(), bs.end());
+    vector<size_t> counts;
+    gs_count_buckets(t, bs, 3, back_inserter(counts));
+    CHECK_EQUAL(bs.size()-1, counts.size());
+    size_t total = 0;
+    for (size_t j = 0; j+1 < bs.size(); ++j) {
+        size_t c = gs_count_range(t, bs[j], bs[j+1], 3);
+        CHECK_EQUAL(c, counts[j]);
+        total += counts[j];
+    }
+    const string& last = bs.back();
+    size_t above = t.size() - gs_count_less(t.begin(), t.size(),
+            last.begin(), last.size(), size_t(3));
+    CHECK_EQUAL(t.size(), total + above);
+}
+
+/*!
+    check that a compiled pattern applied to many texts gives the same counts
+    as counting with the pattern bytes, also for texts of another iterator type
+*/
+TEST(GS, COMPILED) {
+    TestGenerator generator;
+    const string t = generator.generateRandomString(20000);
+    const string l = t.substr(100, 5), u = t.substr(5000, 300);
+    const gs_pattern<size_t> lp(l, 3), up(u, 3);
+    for (size_t d = 0; d < 20; ++d) {
+        const string x = t.substr(d*997, 1000 + d*50);
+        size_t correct = gs_count_range(x, l, u, size_t(3));
+        CHECK_EQUAL(correct, gs_count_range(x, lp, up));
+        CHECK_EQUAL(correct, gs_count_range(x.data(), x.size(), lp, up));
+    }
+    const gs_pattern<size_t> empty("", 4);
+    CHECK_EQUAL(size_t(0), gs_count_less(t.begin(), t.size(), empty));
+}
@@ -4,6 +4,7 @@
 #include "TestGenerator.hpp"
 #include <vector>
 #include <iterator>
+#include <deque>
 
 using namespace rmatch;
 
@@ -74,3 +75,69 @@ TEST(KMP, RANDOM_TEST_BIG) {
 TEST(KMP, RANDOM_TEST_BIG_LONG_PREFIX) {
     kmp_test(1000000, 1773, 4565);
 }
+
+/*!
+    check the common prefix length of character arrays at every alignment and
+    length around the vector widths
+*/
+TEST(MATCH_LENGTH, BYTES) {
+    string a(300, 'x'), b(300, 'x');
+    for (size_t m = 0; m < 200; ++m) {
+        for (size_t d = 0; d <= m; d += 7) {
+            b[d] = 'y';
+            size_t scalar = detail::match_length_scalar(a.data(), b.data(), m);
+            size_t bytes = detail::match_length_bytes(a.data(), b.data(), m);
+            size_t iter = detail::match_length(a.begin(), b.begin(), m);
+            size_t expected = min(d, m);
+            CHECK_EQUAL(expected, scalar);
+            CHECK_EQUAL(scalar, bytes);
+            CHECK_EQUAL(scalar, iter);
+            b[d] = 'x';
+        }
+    }
+}
+
+/*!
+    check that the vectorized prefix extension of character strings finds the
+    same suffixes as the generic one on a periodic text with long matches
+*/
+void kmp_contiguous_test(const string& t, const string& l, const string& u)
+{
+    deque<char> td(t.begin(),t.end()), ld(l.begin(),l.end()),
+        ud(u.begin(),u.end());
+    vector<size_t> generic, contiguous;
+    kmp_match_range(td,ld,ud,back_inserter(generic));
+    kmp_match_range(t,l,u,back_inserter(contiguous));
+    bool same = generic == contiguous;
+    CHECK_EQUAL(true, same);
+}
+
+TEST(KMP, CONTIGUOUS) {
+    string p(1 << 16, 'a');
+    for (size_t i = 0; i < p.size(); ++i) p[i] += i%3;
+    for (size_t i = 1000; i < p.size(); i += 4099) p[i] = 'd';
+    kmp_contiguous_test(p, p.substr(1, 100), p.substr(2, 1000));
+    kmp_contiguous_test(p, p.substr(0, 17), p.substr(0, 5000));
+    kmp_contiguous_test(p, p.substr(990, 3000), p.substr(2, 63));
+}
+
+/*!
+    check that a compiled pattern applied to many texts finds the same
+    suffixes as matching with the pattern bytes, also for texts of another
+    iterator type
+*/
+TEST(KMP, COMPILED) {
+    TestGenerator generator;
+    const string t = generator.generateRandomString(20000);
+    const string l = t.substr(100, 5), u = t.substr(5000, 300);
+    const kmp_pattern<size_t> lp(l), up(u);
+    for (size_t d = 0; d < 20; ++d) {
+        const string x = t.substr(d*997, 1000 + d*50);
+        vector<size_t> correct, compiled, pointer;
+        kmp_match_range(x, l, u, back_inserter(correct));
+        kmp_match_range(x.begin(), x.size(), lp, up, back_inserter(compiled));
+        kmp_match_range(x.data(), x.size(), lp, up, back_inserter(pointer));
+        bool same = correct == compiled && correct == pointer;
+        CHECK_EQUAL(true, same);
+    }
+}
@@ -74,3 +74,37 @@ TEST(NAIVE, RANDOM_TEST_BIG) {
 TEST(NAIVE, RANDOM_TEST_BIG_LONG_PREFIX) {
     naive_test(1000000, 1773, 4565);
 }
+
+/*!
+    check that the vectorized parallel search for character arrays finds the
+    same suffixes as the generic search, also with characters having the sign
+    bit set and on a periodic text with long matches
+*/
+void naive_contiguous_test(const string& t, const string& l, const string& u)
+{
+    vector<char> tv(t.begin(),t.end()), lv(l.begin(),l.end()),
+        uv(u.begin(),u.end());
+    vector<size_t> generic, contiguous;
+    naive_match_range(tv.begin(),tv.end(),lv.begin(),lv.end(),
+            uv.begin(),uv.end(),back_inserter(generic));
+    for (unsigned threads = 1; threads <= 4; ++threads) {
+        contiguous.clear();
+        naive_match_range(t.data(),t.size(),l.data(),l.size(),
+                u.data(),u.size(),back_inserter(contiguous),threads);
+        bool same = generic == contiguous;
+        CHECK_EQUAL(true, same);
+    }
+}
+
+TEST(NAIVE, CONTIGUOUS) {
+    TestGenerator generator;
+    string t = generator.generateRandomString(1 << 18);
+    for (size_t i = 0; i < t.size(); i += 7) t[i] = -t[i];
+    naive_contiguous_test(t, "c", "i");
+    naive_contiguous_test(t, "", "\x90");
+    naive_contiguous_test(t, "\x90", "a");
+    string p(1 << 18, 'a');
+    for (size_t i = 0; i < p.size(); ++i) p[i] += i%3;
+    naive_contiguous_test(p, "abcabcab", "bcabcabcabcabcabcabcabcabcabcabcabca");
+    naive_contiguous_test(p, p.substr(1, 40), p.substr(2, 70));
+}
@@ -0,0 +1,137 @@
+#include "packed_dna.hpp"
+#include "ProjectInc.hpp"
+#include "SuffixArray.hpp"
+#include "kmp_match.hpp"
+#include "check_macros.h"
+#include <vector>
+#include <string>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+
+using namespace rmatch;
+
+using namespace std;
+
+/*!
+    random text of n bases
+*/
+string dna_text(size_t n)
+{
+    string t(n, 'A');
+    uint64_t x = 4321;
+    for (size_t i = 0; i < n; ++i) {
+        x = x*6364136223846793005ull + 1442695040888963407ull;
+        t[i] = "ACGT"[(x >> 33) % 4];
+    }
+    return t;
+}
+
+TEST(PACKED_DNA, PACK) {
+    const string s = dna_text(1000);
+    packed_dna d(s);
+    CHECK_EQUAL(s.size(), d.size());
+    bool same = s == d.str();
+    CHECK_EQUAL(true, same);
+    CHECK_EQUAL(true, packed_dna::packable(s.begin(), s.end()));
+    const string n = "ACGTN";
+    CHECK_EQUAL(false, packed_dna::packable(n.begin(), n.end()));
+
+    // appending in pieces gives the same text
+    packed_dna a(s.begin(), s.begin()+37);
+    a.insert(a.end(), s.begin()+37, s.end());
+    same = a.str() == s;
+    CHECK_EQUAL(true, same);
+
+    // inserting in the middle moves the following bases, also across words
+    for (size_t i = 0; i <= 70; i += 5) {
+        packed_dna m(s.begin(), s.begin()+70);
+        m.insert(m.begin()+i, s.begin()+200, s.begin()+233);
+        string r = s.substr(0, 70);
+        r.insert(i, s.substr(200, 33));
+        if (m.str() != r) same = false;
+    }
+    CHECK_EQUAL(true, same);
+
+    // characters other than bases are rejected, leaving the text as it was
+    packed_dna b(s.begin(), s.begin()+70);
+    bool thrown = false;
+    try {
+        b.insert(b.begin()+10, n.begin(), n.end());
+    } catch (const invalid_argument&) {
+        thrown = true;
+    }
+    CHECK_EQUAL(true, thrown);
+    same = b.str() == s.substr(0, 70);
+    CHECK_EQUAL(true, same);
+    thrown = false;
+    try {
+        b.push_back('N');
+    } catch (const invalid_argument&) {
+        thrown = true;
+    }
+    CHECK_EQUAL(true, thrown);
+    CHECK_EQUAL(size_t(70), b.size());
+
+    // common prefixes of every alignment, also across word boundaries
+    for (size_t i = 0; i < 80; ++i) {
+        for (size_t j = 0; j < 80; ++j) {
+            const size_t max = s.size() - std::max(i, j);
+            size_t l = 0;
+            while (l < max && s[i+l] == s[j+l]) ++l;
+            if (detail::match_length(d.begin()+i, d.begin()+j, max) != l) {
+                same = false;
+            }
+        }
+    }
+    CHECK_EQUAL(true, same);
+    const string p = s.substr(100, 300);
+    packed_dna q(p);
+    size_t l = detail::match_length(d.begin()+100, q.begin(), p.size());
+    CHECK_EQUAL(p.size(), l);
+}
+
+/*!
+    check that every algorithm finds the same suffixes in a packed text as the
+    naive search in the unpacked text
+*/
+void packed_test(const string& t, const string& l, const string& u)
+{
+    vector<size_t> correct;
+    naive_match_range(t, l, u, back_inserter(correct));
+    packed_dna pt(t), pl(l), pu(u);
+
+    vector<size_t> r;
+    naive_match_range(pt, pl, pu, back_inserter(r));
+    bool same = r == correct;
+    CHECK_EQUAL(true, same);
+
+    r.clear();
+    kmp_match_range(pt, pl, pu, back_inserter(r));
+    same = r == correct;
+    CHECK_EQUAL(true, same);
+
+    CHECK_EQUAL(correct.size(), gs_count_range(pt, pl, pu, size_t(3)));
+
+    same = stringRangeMatch(pt, pl, pu) == correct;
+    CHECK_EQUAL(true, same);
+
+    same = stringRangeMatchZ(pt, pl, pu) == correct;
+    CHECK_EQUAL(true, same);
+
+    vector<size_t> s = SuffixArray<packed_dna>(pt).rangeQuery(pl, pu);
+    sort(s.begin(), s.end());
+    same = s == correct;
+    CHECK_EQUAL(true, same);
+}
+
+TEST(PACKED_DNA, MATCH) {
+    const string t = dna_text(20000);
+    packed_test(t, t.substr(10, 3), t.substr(500, 2));
+    packed_test(t, t.substr(77, 40), t.substr(77, 41));
+    packed_test(t, "", "T");
+    string p;
+    for (int i = 0; i < 300; ++i) p += "ACGTTGCA";
+    packed_test(p, p.substr(3, 100), p.substr(5, 70));
+}
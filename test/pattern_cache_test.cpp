@@ -0,0 +1,66 @@
+#include "pattern_cache.hpp"
+#include "gs_count.hpp"
+#include "kmp_match.hpp"
+#include "check_macros.h"
+#include "TestGenerator.hpp"
+#include <vector>
+#include <string>
+#include <thread>
+
+using namespace rmatch;
+
+using namespace std;
+
+/*!
+    check that the least recently requested pattern is evicted and that
+    repeated requests return the same compiled pattern
+*/
+TEST(PATTERN_CACHE, LRU) {
+    pattern_cache<kmp_pattern<size_t>> cache(2);
+    auto a = cache.get("a");
+    auto b = cache.get("b");
+    bool same = cache.get("a") == a;
+    CHECK_EQUAL(true, same);
+    cache.get("c"); // evicts b
+    CHECK_EQUAL(size_t(2), cache.size());
+    same = cache.get("a") == a;
+    CHECK_EQUAL(true, same);
+    same = cache.get("b") == b;
+    CHECK_EQUAL(false, same);
+    CHECK_EQUAL(size_t(2), cache.hits());
+    CHECK_EQUAL(size_t(4), cache.misses());
+    // an evicted pattern stays usable
+    CHECK_EQUAL(size_t(1), a->size());
+}
+
+/*!
+    check that patterns compiled through a factory count the same as the
+    pattern bytes when the cache is shared between threads
+*/
+TEST(PATTERN_CACHE, THREADS) {
+    TestGenerator generator;
+    const string t = generator.generateRandomString(20000);
+    vector<string> ps;
+    for (size_t i = 0; i < 8; ++i) ps.push_back(t.substr(i*2000, 3+i));
+    pattern_cache<gs_pattern<size_t>> cache(4, [](const string& p) {
+        return make_shared<const gs_pattern<size_t>>(p, size_t(3));
+    });
+    vector<size_t> counts(4*ps.size());
+    vector<thread> workers;
+    for (size_t w = 0; w < 4; ++w) {
+        workers.push_back(thread([&,w]() {
+            for (size_t i = 0; i < ps.size(); ++i) {
+                auto p = cache.get(ps[(i+w) % ps.size()]);
+                counts[w*ps.size()+(i+w)%ps.size()] =
+                    gs_count_less(t.begin(), t.size(), *p);
+            }
+        }));
+    }
+    for (auto& w: workers) w.join();
+    for (size_t i = 0; i < counts.size(); ++i) {
+        const string& p = ps[i % ps.size()];
+        CHECK_EQUAL(gs_count_less(t.begin(), t.size(), p.begin(), p.size(),
+                    size_t(3)), counts[i]);
+    }
+    CHECK_EQUAL(size_t(4), cache.size());
+}
@@ -0,0 +1,119 @@
+#include "plan.hpp"
+#include "check_macros.h"
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+
+using namespace std;
+
+/*!
+    cost constants making every algorithm take \a ns per character except
+    \a fast, which takes a tenth of it
+*/
+cost_model costs_with_fastest(method fast, double ns)
+{
+    cost_model costs;
+    for (int i = 0; i < METHOD_COUNT; ++i) costs.ns_per_char[i] = ns;
+    costs.ns_per_char[fast] = ns/10;
+    costs.sa_query_ns = 1;
+    return costs;
+}
+
+TEST(PLAN, FASTEST) {
+    const double memory = 1e18;
+    plan p = choose_method(costs_with_fastest(KMP,10),1<<20,8,false,memory);
+    CHECK_EQUAL(KMP, p.m);
+    p = choose_method(costs_with_fastest(Z,10),1<<20,8,false,memory);
+    CHECK_EQUAL(Z, p.m);
+    bool feasible = p.feasible[Z];
+    CHECK_EQUAL(true, feasible);
+    bool estimate = p.seconds == p.estimates[Z];
+    CHECK_EQUAL(true, estimate);
+}
+
+TEST(PLAN, COUNT_ONLY) {
+    const double memory = 1e18;
+    // Galil-Seiferas only counts the matches
+    plan p = choose_method(costs_with_fastest(GS,10),1<<20,8,false,memory);
+    bool other = p.m != GS;
+    CHECK_EQUAL(true, other);
+    CHECK_EQUAL(false, p.feasible[GS]);
+    p = choose_method(costs_with_fastest(GS,10),1<<20,8,true,memory);
+    CHECK_EQUAL(GS, p.m);
+}
+
+TEST(PLAN, LONG_PATTERNS) {
+    const double memory = 1e18;
+    plan p = choose_method(costs_with_fastest(NAIVE,10),1<<20,
+            naive_max_pattern,false,memory);
+    CHECK_EQUAL(NAIVE, p.m);
+    p = choose_method(costs_with_fastest(NAIVE,10),1<<20,
+            naive_max_pattern+1,false,memory);
+    bool other = p.m != NAIVE;
+    CHECK_EQUAL(true, other);
+}
+
+TEST(PLAN, MEMORY) {
+    const size_t n = 1<<20;
+    // the suffix array is the fastest but does not fit
+    cost_model costs = costs_with_fastest(SA,10);
+    plan p = choose_method(costs,n,8,false,estimate_bytes(SA,n,8)-1);
+    bool other = p.m != SA;
+    CHECK_EQUAL(true, other);
+    CHECK_EQUAL(false, p.feasible[SA]);
+    p = choose_method(costs,n,8,false,estimate_bytes(SA,n,8));
+    CHECK_EQUAL(SA, p.m);
+    // nothing fits, so the algorithm using the least memory is chosen
+    p = choose_method(costs,n,8,false,-1);
+    CHECK_EQUAL(NAIVE, p.m);
+    bool bytes = p.bytes == estimate_bytes(NAIVE,n,8);
+    CHECK_EQUAL(true, bytes);
+}
+
+TEST(PLAN, SUFFIX_ARRAY_QUERY) {
+    cost_model costs;
+    costs.ns_per_char[SA] = 0;
+    costs.sa_query_ns = 1;
+    // one binary search per query character over log2(n+2) levels
+    bool seconds = estimate_seconds(costs,SA,1022,8) == 80*1e-9;
+    CHECK_EQUAL(true, seconds);
+}
+
+/*!
+    path of a new empty temporary file
+*/
+string temp_path()
+{
+    char name[] = "/tmp/rmatch-costs-XXXXXX";
+    int fd = mkstemp(name);
+    close(fd);
+    return name;
+}
+
+TEST(PLAN, LOAD_COSTS) {
+    const string path = temp_path();
+    cost_model saved = costs_with_fastest(C,20);
+    saved.sa_query_ns = 3.5;
+    CHECK_EQUAL(true, save_costs(path,saved));
+    cost_model loaded;
+    CHECK_EQUAL(true, load_costs(path,loaded));
+    for (int i = 0; i < METHOD_COUNT; ++i) {
+        bool same = loaded.ns_per_char[i] == saved.ns_per_char[i];
+        CHECK_EQUAL(true, same);
+    }
+    bool query = loaded.sa_query_ns == 3.5;
+    CHECK_EQUAL(true, query);
+
+    // a file missing constants leaves the costs untouched
+    FILE *f = fopen(path.c_str(),"w");
+    fprintf(f,"%s 1.0\nsa_query 2.0\n",method_names[NAIVE]);
+    fclose(f);
+    cost_model partial = saved;
+    CHECK_EQUAL(false, load_costs(path,partial));
+    bool untouched = partial.ns_per_char[NAIVE] == saved.ns_per_char[NAIVE];
+    CHECK_EQUAL(true, untouched);
+
+    unlink(path.c_str());
+    CHECK_EQUAL(false, load_costs(path,partial));
+}
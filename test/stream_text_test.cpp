@@ -0,0 +1,178 @@
+#include "stream_text.hpp"
+#include "gs_count.hpp"
+#include "kmp_match.hpp"
+#include "async_reader.hpp"
+#include "check_macros.h"
+#include "TestGenerator.hpp"
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <thread>
+#include <cstring>
+#include <cstdio>
+#include <unistd.h>
+
+using namespace rmatch;
+
+using namespace std;
+
+/*!
+    text source reading from a string, at most \a step characters at a time
+*/
+class string_source {
+public:
+    string_source(const string& s, size_t step): s(s), pos(0), step(step) {}
+    size_t read(char *buf, size_t size) {
+        size_t r = min(min(size, step), s.size() - pos);
+        memcpy(buf, s.data() + pos, r);
+        pos += r;
+        return r;
+    }
+private:
+    const string& s;
+    size_t pos, step;
+};
+
+/*!
+    check that streaming the text in small chunks gives the same results as
+    searching the text in memory
+*/
+void stream_test(const string& t, const string& l, const string& u)
+{
+    vector<size_t> correct;
+    kmp_match_range(t, l, u, back_inserter(correct));
+    size_t count = gs_count_range(t, l, u, 3);
+    const size_t chunks[] = { 1, 3, 64, 4096 };
+    for (size_t chunk: chunks) {
+        string_source ks(t, chunk + 1);
+        stream_text<string_source> kt(ks, chunk);
+        vector<size_t> r;
+        kmp_match_range(kt, l.begin(), l.size(), u.begin(), u.size(),
+                back_inserter(r));
+        bool same = r == correct;
+        CHECK_EQUAL(true, same);
+
+        string_source gs(t, chunk);
+        stream_text<string_source> gt(gs, chunk);
+        size_t c = gs_count_range(gt, l.begin(), l.size(), u.begin(),
+                u.size(), size_t(3));
+        CHECK_EQUAL(count, c);
+        CHECK_EQUAL(t.size(), gt.size());
+    }
+}
+
+TEST(STREAM, SMALL) {
+    stream_test("banana", "0", "z");
+    stream_test("banana", "an", "b");
+    stream_test("banana", "", "ana");
+    stream_test("", "a", "b");
+}
+
+TEST(STREAM, RANDOM) {
+    TestGenerator generator;
+    string t = generator.generateRandomString(20000);
+    stream_test(t, t.substr(100, 5), t.substr(200, 3));
+    stream_test(t, t.substr(1000, 300), t.substr(5000, 400));
+}
+
+TEST(STREAM, PERIODIC) {
+    string p(20000, 'a');
+    for (size_t i = 0; i < p.size(); ++i) p[i] += i%3;
+    for (size_t i = 1000; i < p.size(); i += 4099) p[i] = 'd';
+    stream_test(p, p.substr(1, 100), p.substr(2, 1000));
+    stream_test(p, p.substr(0, 17), p.substr(0, 5000));
+}
+
+/*!
+    check that the window kept in memory stays within the lookback
+*/
+TEST(STREAM, LOOKBACK) {
+    string t(100000, 'a');
+    string_source s(t, 100);
+    stream_text<string_source> st(s, 100);
+    size_t c = gs_count_less(st, t.begin(), size_t(50), size_t(3));
+    CHECK_EQUAL(size_t(49), c);
+    CHECK_EQUAL(size_t(51), st.lookback());
+}
+
+/*!
+    write the text to a temporary file and return its open descriptor
+*/
+int temp_file(const string& t)
+{
+    FILE *f = tmpfile();
+    fwrite(t.data(), 1, t.size(), f);
+    fflush(f);
+    int fd = dup(fileno(f));
+    fclose(f);
+    lseek(fd, 0, SEEK_SET);
+    return fd;
+}
+
+/*!
+    check that two consumers of the reader thread counting different bounds in
+    threads of their own agree with the count in memory
+*/
+void async_test(int fd, const string& t, const string& l, const string& u,
+        size_t chunk, size_t slots)
+{
+    typedef stream_text<async_reader::consumer> text;
+    async_reader r(fd, 2, chunk, slots);
+    size_t lc = 0;
+    thread lower([&]() {
+        text lt(r.get(1), chunk/2+1);
+        lc = gs_count_less(lt, l.begin(), l.size(), size_t(3));
+    });
+    text ut(r.get(0), chunk*2);
+    size_t uc = gs_count_less(ut, u.begin(), u.size(), size_t(3));
+    lower.join();
+    size_t count = gs_count_range(t, l, u, 3);
+    size_t streamed = uc < lc ? 0 : uc - lc;
+    CHECK_EQUAL(count, streamed);
+    CHECK_EQUAL(t.size(), ut.size());
+    CHECK_EQUAL(false, r.failed());
+}
+
+TEST(STREAM, ASYNC_FILE) {
+    TestGenerator generator;
+    string t = generator.generateRandomString(100000);
+    const size_t chunks[] = { 1, 100, 1 << 16 };
+    for (size_t chunk: chunks) {
+        int fd = temp_file(t);
+        async_test(fd, t, t.substr(10, 4), t.substr(5000, 5), chunk, 2);
+        close(fd);
+    }
+    // reading starts from the current offset of the descriptor
+    int fd = temp_file(t);
+    lseek(fd, 1000, SEEK_SET);
+    async_test(fd, t.substr(1000), t.substr(10, 4), t.substr(5000, 5), 64, 3);
+    close(fd);
+}
+
+TEST(STREAM, ASYNC_PIPE) {
+    string p(50000, 'a');
+    for (size_t i = 0; i < p.size(); ++i) p[i] += i%3;
+    int fds[2];
+    CHECK_EQUAL(0, pipe(fds));
+    bool written = true;
+    thread writer([&]() {
+        for (size_t i = 0; i < p.size(); i += 777) {
+            size_t w = min<size_t>(777, p.size()-i);
+            if (write(fds[1], p.data()+i, w) != ssize_t(w)) written = false;
+        }
+        close(fds[1]);
+    });
+    async_reader r(fds[0], 1, 1000, 2);
+    stream_text<async_reader::consumer> t(r.get(0), 300);
+    vector<size_t> correct, found;
+    kmp_match_range(p, p.substr(1, 100), p.substr(2, 1000),
+            back_inserter(correct));
+    string l = p.substr(1, 100), u = p.substr(2, 1000);
+    kmp_match_range(t, l.begin(), l.size(), u.begin(), u.size(),
+            back_inserter(found));
+    writer.join();
+    close(fds[0]);
+    CHECK_EQUAL(true, written);
+    bool same = correct == found;
+    CHECK_EQUAL(true, same);
+}